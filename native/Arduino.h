@@ -0,0 +1,141 @@
+#pragma once
+// Minimal Arduino core shim for the native (Linux) build.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#define IRAM_ATTR
+#define PROGMEM
+
+constexpr uint8_t LOW = 0;
+constexpr uint8_t HIGH = 1;
+constexpr uint8_t INPUT = 0x01;
+constexpr uint8_t OUTPUT = 0x03;
+constexpr uint8_t INPUT_PULLUP = 0x05;
+constexpr int RISING = 0x01;
+constexpr int FALLING = 0x02;
+constexpr int CHANGE = 0x03;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+// Host hook: drive a simulated GPIO level, firing any attached interrupt.
+void nativeSetPinLevel(uint8_t pin, int level);
+
+class String {
+public:
+    String() = default;
+    String(const char* text) : value_(text ? text : "") {}
+    String(const std::string& text) : value_(text) {}
+    String(char c) : value_(1, c) {}
+    String(int value) : value_(std::to_string(value)) {}
+    String(unsigned int value) : value_(std::to_string(value)) {}
+    String(long value) : value_(std::to_string(value)) {}
+    String(unsigned long value) : value_(std::to_string(value)) {}
+    String(long long value) : value_(std::to_string(value)) {}
+    String(unsigned long long value) : value_(std::to_string(value)) {}
+
+    const char* c_str() const { return value_.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(value_.size()); }
+    bool isEmpty() const { return value_.empty(); }
+    void reserve(unsigned int size) { value_.reserve(size); }
+
+    char operator[](unsigned int index) const { return index < value_.size() ? value_[index] : '\0'; }
+
+    String& operator+=(const String& other) { value_ += other.value_; return *this; }
+    String& operator+=(const char* other) { value_ += other ? other : ""; return *this; }
+    String& operator+=(char c) { value_ += c; return *this; }
+
+    friend String operator+(const String& lhs, const String& rhs) { return String(lhs.value_ + rhs.value_); }
+    friend String operator+(const String& lhs, const char* rhs) { return String(lhs.value_ + (rhs ? rhs : "")); }
+    friend String operator+(const char* lhs, const String& rhs) { return String((lhs ? lhs : "") + rhs.value_); }
+
+    bool operator==(const String& other) const { return value_ == other.value_; }
+    bool operator==(const char* other) const { return value_ == (other ? other : ""); }
+    bool operator!=(const String& other) const { return !(*this == other); }
+
+    bool equalsIgnoreCase(const String& other) const {
+        if (value_.size() != other.value_.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < value_.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(value_[i])) !=
+                std::tolower(static_cast<unsigned char>(other.value_[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool startsWith(const String& prefix) const { return value_.compare(0, prefix.value_.size(), prefix.value_) == 0; }
+    int indexOf(char c, unsigned int from = 0) const {
+        const size_t pos = value_.find(c, from);
+        return pos == std::string::npos ? -1 : static_cast<int>(pos);
+    }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) {
+            std::swap(from, to);
+        }
+        from = std::min<unsigned int>(from, length());
+        to = std::min<unsigned int>(to, length());
+        return String(value_.substr(from, to - from));
+    }
+    long toInt() const { return std::strtol(value_.c_str(), nullptr, 10); }
+
+private:
+    std::string value_;
+};
+
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    explicit operator bool() const { return true; }
+    size_t print(const char* text) {
+        if (muted) {
+            return std::strlen(text);
+        }
+        return std::fputs(text, stdout) >= 0 ? std::strlen(text) : 0;
+    }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t println(const char* text = "") {
+        size_t n = print(text);
+        if (!muted) {
+            std::fputc('\n', stdout);
+        }
+        return n + 1;
+    }
+    size_t println(const String& text) { return println(text.c_str()); }
+    template <typename T>
+    size_t println(const T& value) { return println(value.toString()); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        const int written = muted ? std::vsnprintf(nullptr, 0, format, args) : std::vprintf(format, args);
+        va_end(args);
+        return written > 0 ? static_cast<size_t>(written) : 0;
+    }
+
+    bool muted = false; // see nativeSetSerialMuted()
+};
+
+// Host hook: drop everything printed to Serial, e.g. while a benchmark times firmware code.
+void nativeSetSerialMuted(bool muted);
+
+extern HardwareSerial Serial;
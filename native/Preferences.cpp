@@ -0,0 +1,104 @@
+#include <Preferences.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+std::mutex g_storeMutex;
+std::map<std::string, std::map<std::string, std::vector<uint8_t>>> g_store;
+uint64_t g_bytesWritten = 0;
+std::atomic<uint32_t> g_writeDelayUs{0};
+} // namespace
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    namespace_ = name ? name : "";
+    readOnly_ = readOnly;
+    open_ = true;
+    return true;
+}
+
+void Preferences::end() {
+    open_ = false;
+}
+
+std::map<std::string, std::vector<uint8_t>>* Preferences::entries() {
+    return open_ ? &g_store[namespace_] : nullptr;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    auto* store = entries();
+    if (!store) {
+        return 0;
+    }
+    auto it = store->find(key);
+    return it != store->end() ? it->second.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    auto* store = entries();
+    if (!store) {
+        return 0;
+    }
+    auto it = store->find(key);
+    if (it == store->end() || it->second.size() > maxLength) {
+        return 0;
+    }
+    std::memcpy(buffer, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (const uint32_t delayUs = g_writeDelayUs.load()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(delayUs));
+    }
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    auto* store = entries();
+    if (!store || readOnly_) {
+        return 0;
+    }
+    const auto* bytes = static_cast<const uint8_t*>(value);
+    (*store)[key].assign(bytes, bytes + length);
+    g_bytesWritten += length;
+    return length;
+}
+
+bool Preferences::isKey(const char* key) {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    auto* store = entries();
+    return store && store->find(key) != store->end();
+}
+
+bool Preferences::remove(const char* key) {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    auto* store = entries();
+    return store && !readOnly_ && store->erase(key) > 0;
+}
+
+bool Preferences::clear() {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    auto* store = entries();
+    if (!store || readOnly_) {
+        return false;
+    }
+    store->clear();
+    return true;
+}
+
+uint64_t Preferences::bytesWritten() {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    return g_bytesWritten;
+}
+
+void Preferences::resetStats() {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    g_bytesWritten = 0;
+}
+
+void Preferences::setWriteDelayUs(uint32_t delayUs) {
+    g_writeDelayUs.store(delayUs);
+}
@@ -0,0 +1,36 @@
+#pragma once
+// In-memory NVS (Preferences) shim for the native build. All instances share one store
+// so data survives end()/begin() cycles within the process like flash would.
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t putBytes(const char* key, const void* value, size_t length);
+    bool isKey(const char* key);
+    bool remove(const char* key);
+    bool clear();
+
+    // Host instrumentation: total payload bytes written through putBytes().
+    static uint64_t bytesWritten();
+    static void resetStats();
+    // Host instrumentation: every putBytes() takes this long, like an erase/program cycle on flash.
+    static void setWriteDelayUs(uint32_t delayUs);
+
+private:
+    std::map<std::string, std::vector<uint8_t>>* entries();
+
+    std::string namespace_;
+    bool open_ = false;
+    bool readOnly_ = true;
+};
@@ -0,0 +1,150 @@
+#include <U8g2lib.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+const u8g2_cb_t u8g2_cb_r0{0};
+
+const uint8_t u8g2_font_ncenB08_tr[] = {1, 0};
+const uint8_t u8g2_font_ncenB24_tr[] = {3, 0};
+const uint8_t u8g2_font_crox1tb_tf[] = {1, 0};
+const uint8_t u8g2_font_crox5tb_tf[] = {2, 0};
+
+namespace {
+constexpr uint8_t kGlyphColumns = 5;
+constexpr uint8_t kGlyphAdvance = 6;
+
+// Classic 5x7 column font, ASCII 0x20..0x7E.
+const uint8_t kFont5x7[][kGlyphColumns] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x41, 0x22, 0x14, 0x08, 0x00}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x01, 0x01},
+    {0x3E, 0x41, 0x41, 0x51, 0x32}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x04, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x00, 0x7F, 0x41, 0x41},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x41, 0x41, 0x7F, 0x00, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x08, 0x14, 0x54, 0x54, 0x3C},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00},
+    {0x00, 0x7F, 0x10, 0x28, 0x44}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08},
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00},
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x08, 0x08, 0x2A, 0x1C, 0x08},
+};
+
+std::atomic<uint32_t> g_i2cClockHz{0};
+
+const uint8_t* glyphFor(uint16_t encoding) {
+    if (encoding < 0x20 || encoding > 0x7E) {
+        encoding = '?';
+    }
+    return kFont5x7[encoding - 0x20];
+}
+} // namespace
+
+void U8G2::updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) {
+    if (tx >= kTileWidth || ty >= kTileHeight) {
+        return;
+    }
+    tw = static_cast<uint8_t>(tx + tw > kTileWidth ? kTileWidth - tx : tw);
+    th = static_cast<uint8_t>(ty + th > kTileHeight ? kTileHeight - ty : th);
+    uint32_t bytes = 0;
+    for (uint8_t row = ty; row < ty + th; ++row) {
+        const size_t offset = static_cast<size_t>(row) * kWidth + tx * 8u;
+        std::memcpy(panel_ + offset, buffer_ + offset, tw * 8u);
+        bytes += kRowCommandBytes + tw * 8u;
+    }
+    transferredBytes_ += bytes;
+    ++transfers_;
+    if (const uint32_t hz = g_i2cClockHz.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<uint64_t>(bytes) * 9u * 1000000u / hz));
+    }
+}
+
+void nativeSetI2cClock(uint32_t hz) { g_i2cClockHz.store(hz, std::memory_order_relaxed); }
+
+void U8G2::drawPixel(int x, int y) {
+    if (x < 0 || y < 0 || x >= kWidth || y >= kHeight) {
+        return;
+    }
+    uint8_t& cell = buffer_[(y / 8) * kWidth + x];
+    const uint8_t mask = static_cast<uint8_t>(1u << (y % 8));
+    if (drawColor_ == 0) {
+        cell &= static_cast<uint8_t>(~mask);
+    } else if (drawColor_ == 2) {
+        cell ^= mask;
+    } else {
+        cell |= mask;
+    }
+}
+
+void U8G2::drawBox(int x, int y, int w, int h) {
+    for (int yy = y; yy < y + h; ++yy) {
+        for (int xx = x; xx < x + w; ++xx) {
+            drawPixel(xx, yy);
+        }
+    }
+}
+
+uint16_t U8G2::drawGlyph(int x, int y, uint16_t encoding) {
+    const uint8_t s = scale();
+    const uint8_t* glyph = glyphFor(encoding);
+    const int top = y - 7 * s;
+    for (int column = 0; column < kGlyphColumns; ++column) {
+        for (int row = 0; row < 7; ++row) {
+            if (glyph[column] & (1u << row)) {
+                drawBox(x + column * s, top + row * s, s, s);
+            }
+        }
+    }
+    return static_cast<uint16_t>(kGlyphAdvance * s);
+}
+
+uint16_t U8G2::drawStr(int x, int y, const char* text) {
+    uint16_t width = 0;
+    for (const char* c = text; c && *c; ++c) {
+        width = static_cast<uint16_t>(width + drawGlyph(x + width, y, static_cast<uint8_t>(*c)));
+    }
+    return width;
+}
+
+uint16_t U8G2::getStrWidth(const char* text) const {
+    return static_cast<uint16_t>(text ? std::strlen(text) * kGlyphAdvance * scale() : 0);
+}
+
+bool U8G2::writePbm(const char* path) const {
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "P4\n%u %u\n", static_cast<unsigned>(kWidth), static_cast<unsigned>(kHeight));
+    for (int y = 0; y < kHeight; ++y) {
+        uint8_t row[kWidth / 8] = {};
+        for (int x = 0; x < kWidth; ++x) {
+            if (panel_[(y / 8) * kWidth + x] & (1u << (y % 8))) {
+                row[x / 8] |= static_cast<uint8_t>(0x80u >> (x % 8));
+            }
+        }
+        std::fwrite(row, 1, sizeof(row), file);
+    }
+    return std::fclose(file) == 0;
+}
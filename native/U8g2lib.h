@@ -0,0 +1,91 @@
+#pragma once
+// U8g2 shim for the native build. Keeps a real SSD1306-layout page buffer (128x64,
+// page-major, LSB = top pixel) so drawing code and framebuffer logic behave like on
+// the device. Glyphs come from a built-in 5x7 font scaled per U8g2 font; they are
+// approximations of the real fonts, not pixel-identical to them.
+
+#include <Arduino.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+struct u8g2_cb_t {
+    uint8_t rotation;
+};
+extern const u8g2_cb_t u8g2_cb_r0;
+#define U8G2_R0 (&u8g2_cb_r0)
+#define U8X8_PIN_NONE 255
+
+// Font descriptors: { scale, reserved }.
+extern const uint8_t u8g2_font_ncenB08_tr[];
+extern const uint8_t u8g2_font_ncenB24_tr[];
+extern const uint8_t u8g2_font_crox1tb_tf[];
+extern const uint8_t u8g2_font_crox5tb_tf[];
+
+// Host hook: transfers take as long as on an I2C bus at hz (9 bit times per byte); 0, the
+// default, makes them instant.
+void nativeSetI2cClock(uint32_t hz);
+
+class U8G2 {
+public:
+    static constexpr uint8_t kTileWidth = 16;
+    static constexpr uint8_t kTileHeight = 8;
+    static constexpr uint16_t kWidth = kTileWidth * 8;
+    static constexpr uint16_t kHeight = kTileHeight * 8;
+    // Modelled I2C cost: control byte + column/page addressing per transferred tile row.
+    static constexpr uint32_t kRowCommandBytes = 8;
+
+    bool begin() { clearBuffer(); return true; }
+    void setBusClock(uint32_t clockSpeed) { (void)clockSpeed; }
+    void setFont(const uint8_t* font) { font_ = font; }
+    void setFontMode(uint8_t mode) { (void)mode; }
+    void setDrawColor(uint8_t color) { drawColor_ = color; }
+
+    void clearBuffer() { std::memset(buffer_, 0, sizeof(buffer_)); }
+    void sendBuffer() { updateDisplayArea(0, 0, kTileWidth, kTileHeight); }
+    void updateDisplay() { sendBuffer(); }
+    void updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th);
+
+    uint8_t* getBufferPtr() { return buffer_; }
+    uint8_t getBufferTileWidth() const { return kTileWidth; }
+    uint8_t getBufferTileHeight() const { return kTileHeight; }
+    uint16_t getDisplayWidth() const { return kWidth; }
+    uint16_t getDisplayHeight() const { return kHeight; }
+
+    void drawPixel(int x, int y);
+    void drawBox(int x, int y, int w, int h);
+    uint16_t drawGlyph(int x, int y, uint16_t encoding);
+    uint16_t drawStr(int x, int y, const char* text);
+    uint16_t getStrWidth(const char* text) const;
+    int8_t getAscent() const { return static_cast<int8_t>(7 * scale()); }
+    int8_t getDescent() const { return static_cast<int8_t>(-1 * scale()); }
+
+    // Host instrumentation: bytes and transfers pushed to the (virtual) panel.
+    uint32_t transferredBytes() const { return transferredBytes_; }
+    uint32_t transfers() const { return transfers_; }
+    const uint8_t* panel() const { return panel_; }
+    void resetTransferStats() { transferredBytes_ = 0; transfers_ = 0; }
+    // Writes what the panel currently shows as binary PBM (P4), lit pixels black.
+    bool writePbm(const char* path) const;
+
+private:
+    uint8_t scale() const { return font_ ? font_[0] : 1; }
+
+    uint8_t buffer_[kTileWidth * 8 * kTileHeight] = {};
+    uint8_t panel_[kTileWidth * 8 * kTileHeight] = {};
+    const uint8_t* font_ = nullptr;
+    uint8_t drawColor_ = 1;
+    uint32_t transferredBytes_ = 0;
+    uint32_t transfers_ = 0;
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+    explicit U8G2_SSD1306_128X64_NONAME_F_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                                 uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE) {
+        (void)rotation;
+        (void)reset;
+        (void)clock;
+        (void)data;
+    }
+};
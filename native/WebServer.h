@@ -0,0 +1,86 @@
+#pragma once
+// WebServer shim for the native build. Routes are registered like on the device;
+// the host drives them with dispatch() instead of a real socket.
+
+#include <Arduino.h>
+#include <functional>
+#include <utility>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+class WebServer {
+public:
+    using THandlerFunction = std::function<void()>;
+
+    explicit WebServer(int port = 80) : port_(port) {}
+
+    void begin() { running_ = true; }
+    void stop() { running_ = false; }
+    void handleClient() {}
+
+    void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, std::move(handler)); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+        routes_.push_back(Route{uri, method, std::move(handler)});
+    }
+    void onNotFound(THandlerFunction handler) { notFound_ = std::move(handler); }
+
+    String uri() const { return uri_; }
+    HTTPMethod method() const { return method_; }
+    int args() const { return static_cast<int>(args_.size()); }
+    String arg(int index) const { return index >= 0 && index < args() ? args_[index].second : String(); }
+    String argName(int index) const { return index >= 0 && index < args() ? args_[index].first : String(); }
+    String arg(const String& name) const {
+        for (const auto& entry : args_) {
+            if (entry.first == name) {
+                return entry.second;
+            }
+        }
+        return String();
+    }
+
+    void send(int code, const char* contentType = nullptr, const String& content = String()) {
+        (void)contentType;
+        responseCode_ = code;
+        response_ = content;
+    }
+    void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+    void send_P(int code, const char* contentType, const char* content) { send(code, contentType, String(content)); }
+
+    // Host hook: run the handler registered for uri/method with the given arguments.
+    int dispatch(HTTPMethod method, const String& uri, std::vector<std::pair<String, String>> args) {
+        uri_ = uri;
+        method_ = method;
+        args_ = std::move(args);
+        responseCode_ = 0;
+        response_ = String();
+        for (const auto& route : routes_) {
+            if (route.uri == uri && (route.method == HTTP_ANY || route.method == method)) {
+                route.handler();
+                return responseCode_;
+            }
+        }
+        if (notFound_) {
+            notFound_();
+        }
+        return responseCode_;
+    }
+    const String& lastResponse() const { return response_; }
+
+private:
+    struct Route {
+        String uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+    };
+
+    int port_;
+    bool running_ = false;
+    std::vector<Route> routes_;
+    THandlerFunction notFound_;
+    String uri_;
+    HTTPMethod method_ = HTTP_ANY;
+    std::vector<std::pair<String, String>> args_;
+    int responseCode_ = 0;
+    String response_;
+};
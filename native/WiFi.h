@@ -0,0 +1,22 @@
+#pragma once
+#include <Arduino.h>
+
+enum wifi_mode_t { WIFI_OFF = 0, WIFI_STA, WIFI_AP, WIFI_AP_STA };
+
+class IPAddress {
+public:
+    String toString() const { return String("192.168.4.1"); }
+};
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode) { mode_ = mode; return true; }
+    bool softAP(const char* ssid, const char* password) { (void)ssid; (void)password; return true; }
+    bool softAPdisconnect(bool wifiOff = false) { (void)wifiOff; return true; }
+    IPAddress softAPIP() const { return IPAddress(); }
+
+private:
+    wifi_mode_t mode_ = WIFI_OFF;
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,122 @@
+// Host-only button check: feeds synthetic edge sequences into the ButtonClassifier and
+// compares the classified presses with the expected ones.
+//
+//   program --button-edges              runs every sequence; exits 1 if one classifies wrongly
+
+#include "services/board/board.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+// One edge from the ISR, or (resync) the level the button task reads once the debounce
+// window has passed, like BoardService::getButtons() does after discarded edges.
+struct Step {
+    uint32_t timeMs;
+    uint8_t level; // LOW = pressed
+    bool resync;
+};
+
+struct Sequence {
+    const char* name;
+    std::vector<Step> steps;
+    std::vector<ButtonState> expected;
+};
+
+Step edge(uint32_t timeMs, uint8_t level) { return {timeMs, level, false}; }
+Step resync(uint32_t timeMs, uint8_t level) { return {timeMs, level, true}; }
+
+const char* stateName(ButtonState state) {
+    switch (state) {
+    case ButtonState::NO_PRESS:
+        return "NO_PRESS";
+    case ButtonState::SHORT_PRESS:
+        return "SHORT";
+    case ButtonState::LONG_PRESS:
+        return "LONG";
+    case ButtonState::EXTRA_LONG_PRESS:
+        return "EXTRA_LONG";
+    }
+    return "?";
+}
+
+std::string describe(const std::vector<ButtonState>& states) {
+    std::string text;
+    for (const ButtonState state : states) {
+        text += text.empty() ? "" : " ";
+        text += stateName(state);
+    }
+    return text.empty() ? "-" : text;
+}
+
+std::vector<ButtonState> run(const Sequence& sequence) {
+    ButtonClassifier classifier(BoardService::LONG_PRESS_THRESHOLD_MS, BoardService::EXTENDED_PRESS_THRESHOLD_MS);
+    std::vector<ButtonState> presses;
+    for (const Step& step : sequence.steps) {
+        ButtonState state = ButtonState::NO_PRESS;
+        if (!step.resync) {
+            ButtonEdge input;
+            input.timeMs = step.timeMs;
+            input.level = step.level;
+            state = classifier.feed(input);
+        } else if (classifier.resyncPending() && static_cast<int32_t>(step.timeMs - classifier.resyncAtMs()) >= 0) {
+            state = classifier.resync(step.timeMs, step.level);
+        }
+        if (state != ButtonState::NO_PRESS) {
+            presses.push_back(state);
+        }
+    }
+    return presses;
+}
+
+int runButtonEdges() {
+    constexpr uint32_t kDebounce = ButtonClassifier::kDebounceMs;
+    constexpr uint32_t kMinPress = ButtonClassifier::kMinPressMs;
+    const Sequence sequences[] = {
+        {"clean short press", {edge(0, LOW), edge(120, HIGH)}, {ButtonState::SHORT_PRESS}},
+        {"bouncing press and release",
+         {edge(0, LOW), edge(2, HIGH), edge(4, LOW), edge(7, HIGH), edge(9, LOW), resync(kDebounce, LOW),
+          edge(300, HIGH), edge(302, LOW), edge(304, HIGH), resync(300 + kDebounce, HIGH)},
+         {ButtonState::SHORT_PRESS}},
+        {"long press", {edge(0, LOW), edge(1500, HIGH)}, {ButtonState::LONG_PRESS}},
+        {"extra long press", {edge(0, LOW), edge(3500, HIGH)}, {ButtonState::EXTRA_LONG_PRESS}},
+        // A single spike: the press edge is taken at once, the release lands in the debounce
+        // window and only the resync sees the button up again.
+        {"EMI spike, resync high", {edge(1000, LOW), edge(1000, HIGH), resync(1000 + kDebounce, HIGH)}, {}},
+        {"EMI burst", {edge(0, LOW), edge(1, HIGH), edge(3, LOW), edge(6, HIGH), resync(kDebounce, HIGH)}, {}},
+        {"glitch just under the minimum", {edge(0, LOW), edge(kMinPress - 1, HIGH)}, {}},
+        {"press at the minimum", {edge(0, LOW), edge(kMinPress, HIGH)}, {ButtonState::SHORT_PRESS}},
+        {"release lost, still pressed at resync",
+         {edge(0, LOW), edge(5, HIGH), resync(kDebounce, LOW), edge(200, HIGH)},
+         {ButtonState::SHORT_PRESS}},
+        {"spike, then a real press",
+         {edge(0, LOW), edge(1, HIGH), resync(kDebounce, HIGH), edge(400, LOW), edge(520, HIGH)},
+         {ButtonState::SHORT_PRESS}},
+        {"two quick presses", {edge(0, LOW), edge(100, HIGH), edge(130, LOW), edge(260, HIGH)},
+         {ButtonState::SHORT_PRESS, ButtonState::SHORT_PRESS}},
+        {"millis() wrap during a press", {edge(UINT32_MAX - 60, LOW), edge(60, HIGH)}, {ButtonState::SHORT_PRESS}},
+    };
+
+    bool ok = true;
+    for (const Sequence& sequence : sequences) {
+        const std::vector<ButtonState> presses = run(sequence);
+        const bool match = presses == sequence.expected;
+        std::printf("%-40s %-12s%s\n", sequence.name, describe(presses).c_str(),
+                    match ? "" : ("  FAIL, expected " + describe(sequence.expected)).c_str());
+        ok = ok && match;
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+int runButtonTool(int argc, char** argv) {
+    if (argc == 2 && std::strcmp(argv[1], "--button-edges") == 0) {
+        return runButtonEdges();
+    }
+    std::fprintf(stderr, "usage: %s --button-edges\n", argv[0]);
+    return 2;
+}
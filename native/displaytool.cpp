@@ -0,0 +1,147 @@
+// Host-only display tool: dumps PBM snapshots of the DisplayService screens and
+// measures render time and transmitted bytes per screen type.
+//
+//   program --snapshot <dir>        writes <dir>/<screen>.pbm, creating <dir> if needed
+//   program --bench [frames]        prints per-screen timing and I2C byte counts, the countdown
+//                                   screens also without the glyph cache (drawStr() per digit)
+
+#include "services/display/displayservice.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+struct Screen {
+    const char* name;
+    // Renders frame number `frame`; consecutive frames differ like they do on the device.
+    void (*draw)(DisplayService& display, uint32_t frame);
+};
+
+ExerciseSummary sampleExercise(uint32_t frame) {
+    static const char* const names[] = {"Hangboard 7/3", "Repeaters"};
+    ExerciseSummary summary;
+    summary.name = TextView{names[frame % 2], std::strlen(names[frame % 2])};
+    summary.setCount = 1;
+    summary.valid = true;
+    return summary;
+}
+
+void drawStatus(DisplayService& display, uint32_t frame) {
+    display.showStatus(frame % 2 ? "Bereit" : "Fertig!", frame % 2 ? "Button drücken" : "Gut gemacht! :)");
+}
+
+void drawChooseExercise(DisplayService& display, uint32_t frame) {
+    display.chooseExercise(sampleExercise(frame), frame % 4 < 2 ? WifiState::INACTIVE : WifiState::ACTIVE);
+}
+
+void drawTimer(DisplayService& display, uint32_t frame) {
+    // Countdown at the default 25 ms frame interval, starting at 01:23:45
+    ExerciseRuntime runtime;
+    runtime.phase = RepState::IN_PROGRESS;
+    runtime.setIndex = 1;
+    runtime.repIndex = static_cast<uint8_t>(frame / 400);
+    const uint32_t elapsed = frame * 25;
+    const unsigned long remaining = elapsed < 83450 ? 83450 - elapsed : 0;
+    display.playTimer(remaining, runtime, 80, WifiState::INACTIVE);
+}
+
+// Last seconds of a hang, where every frame shows new hundredths (30 ms apart at 25 ms pacing)
+void drawTimerFine(DisplayService& display, uint32_t frame) {
+    ExerciseRuntime runtime;
+    runtime.phase = RepState::IN_PROGRESS;
+    const uint32_t elapsed = (frame * 30) % 5000;
+    display.playTimer(5000 - elapsed, runtime, 80, WifiState::INACTIVE);
+}
+
+// PAUSE is drawn over the last timer frame, which stays on screen while paused
+void drawPause(DisplayService& display, uint32_t frame) {
+    if (frame == 0) {
+        drawTimer(display, 0);
+    }
+    display.showPause();
+}
+
+const Screen kScreens[] = {
+    {"status", drawStatus},
+    {"choose_exercise", drawChooseExercise},
+    {"timer", drawTimer},
+    {"timer_fine", drawTimerFine},
+    {"pause", drawPause},
+};
+
+int snapshot(const char* dir) {
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    if (error) {
+        std::fprintf(stderr, "cannot create %s: %s\n", dir, error.message().c_str());
+        return 1;
+    }
+    for (const Screen& screen : kScreens) {
+        DisplayService display;
+        display.begin();
+        screen.draw(display, 0);
+        const std::string path = std::string(dir) + "/" + screen.name + ".pbm";
+        if (!display.device().writePbm(path.c_str())) {
+            std::fprintf(stderr, "cannot write %s\n", path.c_str());
+            return 1;
+        }
+        std::printf("%s\n", path.c_str());
+    }
+    return 0;
+}
+
+void benchScreen(const Screen& screen, const char* label, uint32_t frames, bool glyphCache) {
+    using Clock = std::chrono::steady_clock;
+    DisplayService display;
+    display.begin();
+    display.setGlyphCacheEnabled(glyphCache);
+    screen.draw(display, 0); // first frame is a full sendBuffer, not representative
+    display.resetStats();
+
+    const Clock::time_point start = Clock::now();
+    for (uint32_t frame = 1; frame <= frames; ++frame) {
+        screen.draw(display, frame);
+    }
+    const double elapsedUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    const DisplayService::Stats stats = display.stats();
+    std::printf("%-24s %8u %8u %8u %10.2f %10.1f\n", label, static_cast<unsigned>(frames),
+                static_cast<unsigned>(stats.framesRendered), static_cast<unsigned>(stats.framesPartial),
+                elapsedUs / frames, static_cast<double>(stats.bytesSent) / frames);
+}
+
+int bench(uint32_t frames) {
+    std::printf("%-24s %8s %8s %8s %10s %10s\n", "screen", "frames", "drawn", "partial", "us/frame", "bytes/frame");
+    for (const Screen& screen : kScreens) {
+        benchScreen(screen, screen.name, frames, true);
+    }
+    // The countdown screens again without the glyph cache: every digit through drawStr(), no
+    // partial redraw. The shim's drawStr() is cheaper than U8g2 decoding a compressed font, so
+    // the gap on the device is larger.
+    for (const Screen& screen : kScreens) {
+        if (std::strncmp(screen.name, "timer", 5) == 0) {
+            const std::string label = std::string(screen.name) + " (drawStr)";
+            benchScreen(screen, label.c_str(), frames, false);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int runDisplayTool(int argc, char** argv) {
+    if (argc >= 3 && std::strcmp(argv[1], "--snapshot") == 0) {
+        return snapshot(argv[2]);
+    }
+    if (std::strcmp(argv[1], "--bench") == 0) {
+        const long frames = argc >= 3 ? std::strtol(argv[2], nullptr, 10) : 2000;
+        return bench(frames > 0 ? static_cast<uint32_t>(frames) : 2000);
+    }
+    std::fprintf(stderr, "usage: %s [--snapshot <dir> | --bench [frames]]\n", argv[0]);
+    return 2;
+}
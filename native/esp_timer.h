@@ -0,0 +1,5 @@
+#pragma once
+#include <cstdint>
+
+// Microseconds since process start, monotonic.
+int64_t esp_timer_get_time();
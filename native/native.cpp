@@ -0,0 +1,226 @@
+// Runtime backing for the native shims: clock, GPIO, tasks, mutexes and the program entry point.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Wire.h>
+#include <freertos/semphr.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+
+HardwareSerial Serial;
+TwoWire Wire;
+WiFiClass WiFi;
+
+void nativeSetSerialMuted(bool muted) { Serial.muted = muted; }
+
+namespace {
+using Clock = std::chrono::steady_clock;
+const Clock::time_point kProcessStart = Clock::now();
+
+// Function-local statics: firmware globals (e.g. BoardService) touch GPIO during
+// static initialisation, before namespace-scope objects here are guaranteed to exist.
+struct GpioState {
+    std::mutex mutex;
+    std::map<uint8_t, int> levels;
+    std::map<uint8_t, void (*)()> handlers;
+};
+
+GpioState& gpio() {
+    static GpioState state;
+    return state;
+}
+
+std::recursive_mutex& criticalMutex() {
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+} // namespace
+
+struct NativeTask {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notifications = 0;
+};
+
+struct NativeSemaphore {
+    std::timed_mutex mutex;
+};
+
+namespace {
+thread_local NativeTask* t_currentTask = nullptr;
+} // namespace
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - kProcessStart).count();
+}
+
+unsigned long millis() { return static_cast<unsigned long>(esp_timer_get_time() / 1000); }
+unsigned long micros() { return static_cast<unsigned long>(esp_timer_get_time()); }
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    GpioState& state = gpio();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (mode == INPUT_PULLUP && state.levels.find(pin) == state.levels.end()) {
+        state.levels[pin] = HIGH;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    GpioState& state = gpio();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto it = state.levels.find(pin);
+    return it != state.levels.end() ? it->second : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    nativeSetPinLevel(pin, value);
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode) {
+    (void)mode;
+    GpioState& state = gpio();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.handlers[pin] = handler;
+}
+
+void detachInterrupt(uint8_t pin) {
+    GpioState& state = gpio();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.handlers.erase(pin);
+}
+
+void nativeSetPinLevel(uint8_t pin, int level) {
+    void (*handler)() = nullptr;
+    {
+        GpioState& state = gpio();
+    std::lock_guard<std::mutex> lock(state.mutex);
+        int& current = state.levels[pin];
+        if (current == level) {
+            return;
+        }
+        current = level;
+        auto it = state.handlers.find(pin);
+        if (it != state.handlers.end()) {
+            handler = it->second;
+        }
+    }
+    if (handler) {
+        handler();
+    }
+}
+
+void nativeEnterCritical(portMUX_TYPE*) { criticalMutex().lock(); }
+void nativeExitCritical(portMUX_TYPE*) { criticalMutex().unlock(); }
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                       void* parameter, UBaseType_t priority, TaskHandle_t* outHandle) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    auto* task = new NativeTask();
+    if (outHandle) {
+        *outHandle = task;
+    }
+    std::thread([task, function, parameter]() {
+        t_currentTask = task;
+        function(parameter);
+    }).detach();
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+TickType_t xTaskGetTickCount() { return static_cast<TickType_t>(millis()); }
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (!t_currentTask) {
+        t_currentTask = new NativeTask();
+    }
+    return t_currentTask;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) {
+        return pdFALSE;
+    }
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        ++task->notifications;
+    }
+    task->cv.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    NativeTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto ready = [task]() { return task->notifications > 0; };
+    if (ticksToWait == portMAX_DELAY) {
+        task->cv.wait(lock, ready);
+    } else {
+        task->cv.wait_for(lock, std::chrono::milliseconds(ticksToWait), ready);
+    }
+    const uint32_t value = task->notifications;
+    if (value > 0) {
+        task->notifications = clearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeSemaphore(); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    if (ticksToWait == portMAX_DELAY) {
+        semaphore->mutex.lock();
+        return pdTRUE;
+    }
+    return semaphore->mutex.try_lock_for(std::chrono::milliseconds(ticksToWait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+void setup();
+void loop();
+int runDisplayTool(int argc, char** argv);
+int runStorageBench(int argc, char** argv);
+int runTimerTool(int argc, char** argv);
+int runButtonTool(int argc, char** argv);
+
+int main(int argc, char** argv) {
+    // Any argument selects a host tool instead of the firmware loop.
+    if (argc > 1) {
+        if (std::strncmp(argv[1], "--storage", 9) == 0) {
+            return runStorageBench(argc, argv);
+        }
+        if (std::strncmp(argv[1], "--timer", 7) == 0) {
+            return runTimerTool(argc, argv);
+        }
+        if (std::strncmp(argv[1], "--button", 8) == 0) {
+            return runButtonTool(argc, argv);
+        }
+        return runDisplayTool(argc, argv);
+    }
+    setup();
+    for (;;) {
+        loop();
+        delay(1);
+    }
+}
@@ -0,0 +1,3 @@
+#pragma once
+// PROGMEM is a no-op on the native build; data lives in regular memory.
+#include <Arduino.h>
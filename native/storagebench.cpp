@@ -0,0 +1,990 @@
+// Host-only storage benchmark.
+//
+//   program --storage-bench [lookups]   lookup cost against library size and NVS bytes
+//                                       written per edit (journal vs. full rewrite),
+//                                       snapshot size v1 vs. v3, boot time and heap of
+//                                       the index, cold/cached body loads, heap traffic of a
+//                                       web save (Exercise graph vs. ExerciseBuilder) and
+//                                       write-behind commits vs. saving after every edit, and
+//                                       the heap the model types use (compare a build with
+//                                       -DMODEL_FIXED_CAPACITY)
+//   program --storage-stress [seconds]  readers on the lock-free snapshots against a writer
+//                                       going through the PersistenceWorker; exits 1 if a
+//                                       reader saw an inconsistent exercise. Build with
+//                                       -fsanitize=thread or =address to check the memory side.
+//   program --storage-codec [--exercises n] [--min-ms ms] [--csv file] [--baseline file]
+//           [--tolerance percent]       encode/decode/round trip of bodies (ExerciseView), the
+//                                       index snapshot (serialize/deserialize through compact()
+//                                       and loadPersistent()) and ids (toHex/fromHex) for
+//                                       libraries of 1 ... n exercises in three shapes up to the
+//                                       kMax* limits; time, MB/s, allocations and bytes per op.
+//                                       --csv writes the rows, --baseline compares against such
+//                                       a file and exits 1 on more allocations or bytes, or on
+//                                       a time beyond the tolerance (default 100 %, 0 = off).
+
+#include "models/timeline.h"
+#include "services/storage/persistenceworker.h"
+#include "services/storage/storageservice.h"
+
+#include <Preferences.h>
+#include <freertos/task.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Heap accounting for the boot table. Every allocation carries its size in a header so
+// live bytes can be tracked; the default array forms route through these as well.
+namespace {
+std::atomic<size_t> g_liveBytes{0};
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_peakBytes{0};
+constexpr size_t kHeapHeader = alignof(std::max_align_t);
+} // namespace
+
+void* operator new(size_t size) {
+    void* block = std::malloc(size + kHeapHeader);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    const size_t live = g_liveBytes += size;
+    size_t peak = g_peakBytes;
+    while (live > peak && !g_peakBytes.compare_exchange_weak(peak, live)) {
+    }
+    ++g_allocations;
+    return static_cast<char*>(block) + kHeapHeader;
+}
+
+void operator delete(void* pointer) noexcept {
+    if (!pointer) {
+        return;
+    }
+    void* block = static_cast<char*>(pointer) - kHeapHeader;
+    g_liveBytes -= *static_cast<size_t*>(block);
+    std::free(block);
+}
+
+void operator delete(void* pointer, size_t) noexcept { operator delete(pointer); }
+
+// Allocation counter for the other host tools (see timertool.cpp --timer-alloc)
+size_t nativeAllocationCount() { return g_allocations; }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Exercise makeExercise(size_t index) {
+    Exercise exercise("Uebung " + std::to_string(index));
+    Set set("A", 180, 80);
+    for (int rep = 0; rep < 6; ++rep) {
+        set.reps.emplace_back(7, 3);
+    }
+    exercise.sets.push_back(set);
+    return exercise;
+}
+
+// Keeps the optimiser from discarding lookups whose result is otherwise unused.
+volatile uintptr_t g_sink = 0;
+
+template <typename Lookup>
+double nsPerLookup(const std::vector<StorageService::ExerciseId>& ids, uint32_t lookups, Lookup lookup) {
+    const Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < lookups; ++i) {
+        g_sink = g_sink + reinterpret_cast<uintptr_t>(lookup(ids[(i * 7919u) % ids.size()]).name.data);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / lookups;
+}
+
+// Edits `edits` exercises one by one and saves after each, as the web handlers did before the
+// PersistenceWorker.
+double bytesPerEdit(size_t size, uint32_t edits, bool fullRewrite) {
+    StorageService storage;
+    std::vector<StorageService::ExerciseId> ids;
+    for (size_t i = 0; i < size; ++i) {
+        StorageService::ExerciseId id{};
+        storage.addExercise(makeExercise(i), &id);
+        ids.push_back(id);
+    }
+    storage.compact();
+
+    Preferences::resetStats();
+    for (uint32_t edit = 0; edit < edits; ++edit) {
+        Exercise exercise = makeExercise(edit);
+        exercise.sets[0].percentMaxIntensity = static_cast<int>(50 + edit % 50);
+        storage.updateExercise(ids[(edit * 7919u) % ids.size()], exercise);
+        if (fullRewrite) {
+            storage.compact();
+        } else {
+            storage.savePersistent();
+        }
+    }
+    return static_cast<double>(Preferences::bytesWritten()) / edits;
+}
+
+// Size the v1 layout (fixed 16/32-bit fields, one entry per rep) would need.
+size_t v1SnapshotBytes(StorageService& storage) {
+    size_t bytes = 2 + 2 + 4; // version, count, journal epoch
+    const StorageService::LibraryRef library = storage.library();
+    for (size_t slot = 0; slot < library->size(); ++slot) {
+        const StorageService::ExerciseRef ref = storage.exerciseAt(*library, slot);
+        const ExerciseView& exercise = ref.view();
+        bytes += 16 + 2 + exercise.name().size + 2;
+        for (size_t set = 0; set < exercise.setCount(); ++set) {
+            bytes += 2 + exercise.set(set).label().size + 4 + 4 + 2 + exercise.set(set).repCount() * 8;
+        }
+    }
+    return bytes;
+}
+
+// A library of `size` exercises with `sets` sets of `reps` equal reps each, as the web form creates them.
+void reportFormat(const char* name, size_t size, size_t sets, int reps) {
+    StorageService storage;
+    for (size_t i = 0; i < size; ++i) {
+        Exercise exercise("Uebung " + std::to_string(i));
+        for (size_t set = 0; set < sets; ++set) {
+            Set entry("Satz " + std::to_string(set + 1), 180, 80);
+            for (int rep = 0; rep < reps; ++rep) {
+                entry.reps.emplace_back(7, 3);
+            }
+            exercise.sets.push_back(entry);
+        }
+        storage.addExercise(exercise);
+    }
+    Preferences::resetStats();
+    storage.compact();
+    const size_t v1 = v1SnapshotBytes(storage);
+    const size_t v2 = static_cast<size_t>(Preferences::bytesWritten());
+    std::printf("%-22s %8u %8u %8.1f%%\n", name, static_cast<unsigned>(v1), static_cast<unsigned>(v2),
+                100.0 * (1.0 - static_cast<double>(v2) / v1));
+}
+
+// Boot: loadPersistent() of a library of `size` exercises with 5 pyramid sets of 10 reps each
+// (every rep differs, so nothing collapses into rep groups). Only the index is read; a body is loaded when an exercise is selected ("cold") and then served from
+// the cache. "library B" is what keeping every body resident would cost.
+void reportBoot(size_t size) {
+    size_t libraryBytes = 0;
+    {
+        StorageService storage;
+        for (size_t i = 0; i < size; ++i) {
+            Exercise exercise("Uebung " + std::to_string(i));
+            for (int set = 0; set < 5; ++set) {
+                Set entry("Satz " + std::to_string(set + 1), 180, 80);
+                for (int rep = 0; rep < 10; ++rep) {
+                    entry.reps.emplace_back(5 + rep, 20 - rep);
+                }
+                exercise.sets.push_back(entry);
+            }
+            std::vector<uint8_t> body;
+            ExerciseView::encode(body, exercise);
+            libraryBytes += body.size();
+            storage.addExercise(exercise);
+        }
+        storage.compact();
+    }
+
+    StorageService storage;
+    const size_t heapBefore = g_liveBytes;
+    const size_t allocationsBefore = g_allocations;
+    Clock::time_point start = Clock::now();
+    storage.loadPersistent();
+    const double bootUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    const size_t bootHeap = g_liveBytes - heapBefore;
+    const size_t bootAllocations = g_allocations - allocationsBefore;
+
+    const StorageService::LibraryRef library = storage.library();
+    start = Clock::now();
+    g_sink = g_sink + storage.exerciseAt(*library, size / 2)->setCount();
+    const double coldUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    start = Clock::now();
+    g_sink = g_sink + storage.exerciseAt(*library, size / 2)->setCount();
+    const double cachedUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    // Browsing the whole library keeps at most kBodyCacheSize bodies resident
+    for (size_t slot = 0; slot < library->size(); ++slot) {
+        g_sink = g_sink + storage.exerciseAt(*library, slot)->setCount();
+    }
+    const size_t browsedHeap = g_liveBytes - heapBefore;
+
+    std::printf("%10u %10.1f %10u %10u %10u %10u %10.2f %10.2f\n", static_cast<unsigned>(size), bootUs,
+                static_cast<unsigned>(bootAllocations), static_cast<unsigned>(bootHeap),
+                static_cast<unsigned>(browsedHeap), static_cast<unsigned>(libraryBytes), coldUs, cachedUs);
+}
+
+struct HeapUse {
+    size_t allocations;
+    size_t peakBytes; // above the heap in use before the save
+    size_t retainedBytes;
+};
+
+// One web save into a library of 32 exercises: `sets` sets of `reps` equal reps, built the way
+// handleSubmit() did before (an Exercise with a string and a rep vector per set) or with an
+// ExerciseBuilder, then added or written over an existing exercise.
+HeapUse webSave(size_t sets, int reps, bool builder, bool update) {
+    StorageService storage;
+    StorageService::ExerciseId target{};
+    for (size_t i = 0; i < 32; ++i) {
+        storage.addExercise(makeExercise(i), &target);
+    }
+    storage.compact();
+
+    const std::string name = "Uebung aus dem Formular";
+    const size_t liveBefore = g_liveBytes;
+    const size_t allocationsBefore = g_allocations;
+    g_peakBytes = liveBefore;
+    if (builder) {
+        ExerciseBuilder exercise(name, ExerciseBuilder::capacity(sets, 1, StorageService::kMaxExerciseNameLength,
+                                                                 StorageService::kMaxSetLabelLength));
+        for (size_t set = 0; set < sets; ++set) {
+            exercise.addSet("Satz " + std::to_string(set + 1), 180, 80);
+            exercise.addReps(static_cast<uint32_t>(reps), Rep(7, 3));
+        }
+        update ? storage.updateExercise(target, exercise.view()) : storage.addExercise(exercise.view());
+    } else {
+        Exercise exercise(name);
+        for (size_t set = 0; set < sets; ++set) {
+            Set entry("Satz " + std::to_string(set + 1), 180, 80);
+            for (int rep = 0; rep < reps; ++rep) {
+                entry.reps.emplace_back(7, 3);
+            }
+            exercise.sets.push_back(std::move(entry));
+        }
+        update ? storage.updateExercise(target, exercise) : storage.addExercise(exercise);
+    }
+    return {g_allocations - allocationsBefore, g_peakBytes - liveBefore, g_liveBytes - liveBefore};
+}
+
+void reportWebSave(const char* name, size_t sets, int reps, bool update) {
+    const HeapUse graph = webSave(sets, reps, false, update);
+    const HeapUse built = webSave(sets, reps, true, update);
+    std::printf("%-26s %10u %10u %10u %10u %10u\n", name, static_cast<unsigned>(graph.allocations),
+                static_cast<unsigned>(graph.peakBytes), static_cast<unsigned>(built.allocations),
+                static_cast<unsigned>(built.peakBytes), static_cast<unsigned>(built.retainedBytes));
+}
+
+// An editable copy (toExercise) and a timeline build of one stored exercise with `sets` sets of
+// `reps` reps that all differ. "held B" is what the copy keeps on the heap while it lives.
+void reportModel(const char* name, size_t sets, int reps) {
+    StorageService storage;
+    Exercise exercise("Uebung");
+    for (size_t set = 0; set < sets; ++set) {
+        Set entry("Satz " + std::to_string(set + 1), 180, 80);
+        for (int rep = 0; rep < reps; ++rep) {
+            entry.reps.emplace_back(5 + rep, 60 - rep);
+        }
+        exercise.sets.push_back(entry);
+    }
+    StorageService::ExerciseId id{};
+    storage.addExercise(exercise, &id);
+    const StorageService::ExerciseRef ref = storage.find(id);
+
+    size_t liveBefore = g_liveBytes;
+    size_t allocationsBefore = g_allocations;
+    const Exercise copy = ref->toExercise();
+    const size_t copyAllocations = g_allocations - allocationsBefore;
+    const size_t copyHeld = g_liveBytes - liveBefore;
+
+    ExerciseTimeline timeline;
+    liveBefore = g_liveBytes;
+    allocationsBefore = g_allocations;
+    timeline.build(ref.view());
+    const size_t timelineAllocations = g_allocations - allocationsBefore;
+    const size_t timelineHeld = g_liveBytes - liveBefore;
+    g_sink = g_sink + copy.sets.size() + timeline.size();
+
+    std::printf("%-22s %10u %10u %10u %10u %10u\n", name, static_cast<unsigned>(sizeof(copy)),
+                static_cast<unsigned>(copyAllocations), static_cast<unsigned>(copyHeld),
+                static_cast<unsigned>(timelineAllocations), static_cast<unsigned>(timelineHeld));
+}
+
+void runPersistenceTask(void* worker) { static_cast<PersistenceWorker*>(worker)->run(); }
+
+// A burst of `edits` web edits `intervalMs` apart against a library of 32 exercises. quietMs == 0
+// saves synchronously after every edit; otherwise a PersistenceWorker with that policy runs in
+// its own task. Handler time covers the mutation plus (synchronous) saving, as seen by the client.
+// flashMs delays every NVS write; the worker writes without its lock, so edits made during a
+// commit should not wait for it.
+// requestFlush asks the worker to write right after the last edit, as the timer task does
+// when an exercise ends.
+void reportWriteBehind(const char* name, uint32_t quietMs, uint32_t maxDelayMs, uint32_t edits, uint32_t intervalMs,
+                       uint32_t flashMs = 0, bool requestFlush = false) {
+    // the worker task never returns, so the storage it writes for stays alive until exit
+    auto* storage = new StorageService();
+    auto* worker = new PersistenceWorker(*storage);
+    std::vector<StorageService::ExerciseId> ids;
+    for (size_t i = 0; i < 32; ++i) {
+        StorageService::ExerciseId id{};
+        storage->addExercise(makeExercise(i), &id);
+        ids.push_back(id);
+    }
+    storage->compact();
+    if (quietMs > 0) {
+        worker->begin();
+        worker->setPolicy({quietMs, maxDelayMs});
+        xTaskCreate(runPersistenceTask, "PersistenceTask", 4096, worker, 1, nullptr);
+    }
+
+    Preferences::resetStats();
+    Preferences::setWriteDelayUs(flashMs * 1000);
+    double handlerUs = 0;
+    double maxHandlerUs = 0;
+    for (uint32_t edit = 0; edit < edits; ++edit) {
+        Exercise exercise = makeExercise(edit);
+        exercise.sets[0].percentMaxIntensity = static_cast<int>(50 + edit % 50);
+        const StorageService::ExerciseId& id = ids[(edit * 7919u) % ids.size()];
+        const Clock::time_point start = Clock::now();
+        if (quietMs > 0) {
+            worker->modify([&](StorageService& target) { return target.updateExercise(id, exercise); });
+        } else {
+            storage->updateExercise(id, exercise);
+            storage->savePersistent();
+        }
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        handlerUs += us;
+        maxHandlerUs = std::max(maxHandlerUs, us);
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    }
+
+    uint32_t commits = edits;
+    uint32_t latencyMs = 0;
+    if (quietMs > 0) {
+        if (requestFlush) {
+            worker->requestFlush();
+        }
+        // everything written once the window after the last edit has passed
+        while (worker->stats().pendingChanges > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        const PersistenceWorker::Stats stats = worker->stats();
+        commits = stats.commits;
+        latencyMs = stats.maxLatencyMs;
+    }
+    Preferences::setWriteDelayUs(0);
+    std::printf("%-24s %8u %10u %12.1f %12.1f %12u\n", name, static_cast<unsigned>(commits),
+                static_cast<unsigned>(Preferences::bytesWritten()), handlerUs / edits, maxHandlerUs,
+                static_cast<unsigned>(latencyMs));
+}
+
+// Stress exercises are derived from a seed stored in their name, so a reader can check any
+// snapshot and body it gets against what the writer must have stored.
+Exercise stressExercise(uint32_t seed) {
+    Exercise exercise("s" + std::to_string(seed));
+    for (uint32_t set = 0; set < seed % 4 + 1; ++set) {
+        Set entry("Satz " + std::to_string(set + 1), static_cast<int>(seed % 90), 80);
+        for (uint32_t rep = 0; rep < (seed / 4) % 5 + 1; ++rep) {
+            entry.reps.emplace_back(static_cast<int>(seed % 50 + 1), static_cast<int>(rep + 1));
+        }
+        exercise.sets.push_back(entry);
+    }
+    return exercise;
+}
+
+bool stressSeed(const TextView& name, uint32_t& seed) {
+    if (name.size < 2 || name.size > 11 || name.data[0] != 's') {
+        return false;
+    }
+    seed = static_cast<uint32_t>(std::strtoul(std::string(name.data + 1, name.size - 1).c_str(), nullptr, 10));
+    return true;
+}
+
+bool stressSummaryValid(const ExerciseSummary& summary) {
+    uint32_t seed = 0;
+    return summary && stressSeed(summary.name, seed) && summary.setCount == seed % 4 + 1;
+}
+
+bool stressBodyValid(const ExerciseView& view) {
+    uint32_t seed = 0;
+    if (!view || !stressSeed(view.name(), seed) || view.setCount() != seed % 4 + 1) {
+        return false;
+    }
+    for (size_t set = 0; set < view.setCount(); ++set) {
+        const SetView entry = view.set(set);
+        if (entry.repCount() != (seed / 4) % 5 + 1 || entry.rep(0).timeRep != static_cast<int>(seed % 50 + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A body read through a snapshot must be exactly the one that snapshot's summary describes
+bool stressBodyMatches(const ExerciseSummary& summary, const ExerciseView& view) {
+    return stressBodyValid(view) && view.name().size == summary.name.size &&
+           std::memcmp(view.name().data, summary.name.data, summary.name.size) == 0;
+}
+
+// Exercise shapes for the codec suite: the smallest valid exercise, what the web form creates, and
+// one at every kMax* limit with all reps different, so nothing collapses into rep groups.
+const char* const kCodecShapes[] = {"min", "form", "max"};
+
+Exercise codecExercise(size_t shape, size_t index) {
+    if (shape == 0) {
+        Exercise exercise("u" + std::to_string(index));
+        Set set("A", 0, 100);
+        set.reps.emplace_back(7, 3);
+        exercise.sets.push_back(set);
+        return exercise;
+    }
+    if (shape == 1) {
+        Exercise exercise("Uebung " + std::to_string(index));
+        for (int set = 0; set < 5; ++set) {
+            Set entry("Satz " + std::to_string(set + 1), 180, 80);
+            for (int rep = 0; rep < 10; ++rep) {
+                entry.reps.emplace_back(7, 3);
+            }
+            exercise.sets.push_back(entry);
+        }
+        return exercise;
+    }
+    std::string name = "Uebung " + std::to_string(index);
+    name.resize(StorageService::kMaxExerciseNameLength, 'x');
+    Exercise exercise(name);
+    for (size_t set = 0; set < StorageService::kMaxSets; ++set) {
+        std::string label = "Satz " + std::to_string(set + 1);
+        label.resize(StorageService::kMaxSetLabelLength, '-');
+        Set entry(label, static_cast<int>(600 + set), 100);
+        for (size_t rep = 0; rep < StorageService::kMaxRepsPerSet; ++rep) {
+            entry.reps.emplace_back(static_cast<int>(5 + rep), static_cast<int>(60 - rep));
+        }
+        exercise.sets.push_back(entry);
+    }
+    return exercise;
+}
+
+size_t snapshotBytes() {
+    Preferences prefs;
+    prefs.begin("interval", true);
+    const size_t bytes = prefs.getBytesLength("exercises");
+    prefs.end();
+    return bytes;
+}
+
+bool sameExercise(const Exercise& a, const Exercise& b) {
+    if (a.name.size() != b.name.size() || std::memcmp(a.name.data(), b.name.data(), a.name.size()) != 0 ||
+        a.sets.size() != b.sets.size()) {
+        return false;
+    }
+    for (size_t set = 0; set < a.sets.size(); ++set) {
+        const Set& x = a.sets[set];
+        const Set& y = b.sets[set];
+        if (x.label.size() != y.label.size() || std::memcmp(x.label.data(), y.label.data(), x.label.size()) != 0 ||
+            x.timePauseAfter != y.timePauseAfter || x.percentMaxIntensity != y.percentMaxIntensity ||
+            x.reps.size() != y.reps.size()) {
+            return false;
+        }
+        for (size_t rep = 0; rep < x.reps.size(); ++rep) {
+            if (x.reps[rep].timeRep != y.reps[rep].timeRep || x.reps[rep].timeRest != y.reps[rep].timeRest) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+struct CodecResult {
+    std::string key; // case,exercises,op as in the CSV
+    double nsPerOp = 0;
+    double mbPerS = 0;
+    size_t allocationsPerOp = 0;
+    size_t bytes = 0;
+};
+
+constexpr uint32_t kCodecBatches = 5;
+
+// An operation of the codec suite; run() returns the bytes it encoded or decoded.
+struct CodecOp {
+    const char* name;
+    std::function<size_t()> run;
+};
+
+// Allocations and bytes come from one call per op, all made before any timing, so the state the
+// ops leave behind (e.g. the journal epoch in the snapshot) is the same on every run. The time is
+// the best mean of kCodecBatches batches that together take about minMs, which keeps scheduler
+// noise out of the baseline comparison.
+void measureCodec(const char* name, size_t exercises, const std::vector<CodecOp>& ops, uint32_t minMs,
+                  std::vector<CodecResult>& results) {
+    const size_t first = results.size();
+    for (const CodecOp& op : ops) {
+        CodecResult result;
+        result.key = std::string(name) + "," + std::to_string(exercises) + "," + op.name;
+        const size_t allocationsBefore = g_allocations;
+        result.bytes = op.run();
+        result.allocationsPerOp = g_allocations - allocationsBefore;
+        results.push_back(result);
+    }
+    for (size_t index = 0; index < ops.size(); ++index) {
+        CodecResult& result = results[first + index];
+        result.nsPerOp = 0;
+        for (uint32_t batch = 0; batch < kCodecBatches; ++batch) {
+            uint32_t runs = 0;
+            const Clock::time_point start = Clock::now();
+            double elapsedNs = 0;
+            do {
+                g_sink = g_sink + ops[index].run();
+                ++runs;
+                elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            } while (elapsedNs < minMs * 1e6 / kCodecBatches);
+            const double nsPerOp = elapsedNs / runs;
+            result.nsPerOp = batch == 0 ? nsPerOp : std::min(result.nsPerOp, nsPerOp);
+        }
+        result.mbPerS = result.bytes * 1e3 / result.nsPerOp;
+    }
+}
+
+bool readBaseline(const char* path, std::vector<CodecResult>& baseline) {
+    std::FILE* file = std::fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    char line[256];
+    while (std::fgets(line, sizeof(line), file)) {
+        char name[32];
+        char op[32];
+        unsigned exercises = 0;
+        CodecResult row;
+        unsigned long allocations = 0;
+        unsigned long bytes = 0;
+        if (std::sscanf(line, "%31[^,],%u,%31[^,],%lf,%lf,%lu,%lu", name, &exercises, op, &row.nsPerOp,
+                        &row.mbPerS, &allocations, &bytes) != 7) {
+            continue; // header
+        }
+        row.key = std::string(name) + "," + std::to_string(exercises) + "," + op;
+        row.allocationsPerOp = allocations;
+        row.bytes = bytes;
+        baseline.push_back(row);
+    }
+    std::fclose(file);
+    return true;
+}
+
+// More allocations or bytes than the baseline are always a regression, time only beyond the tolerance.
+uint32_t reportRegressions(const std::vector<CodecResult>& results, const std::vector<CodecResult>& baseline,
+                           double tolerancePercent) {
+    uint32_t regressions = 0;
+    for (const CodecResult& result : results) {
+        const auto it = std::find_if(baseline.begin(), baseline.end(),
+                                     [&](const CodecResult& row) { return row.key == result.key; });
+        if (it == baseline.end()) {
+            std::printf("new        %s\n", result.key.c_str());
+            continue;
+        }
+        if (result.allocationsPerOp > it->allocationsPerOp) {
+            std::printf("REGRESSION %s: %u -> %u allocations\n", result.key.c_str(),
+                        static_cast<unsigned>(it->allocationsPerOp), static_cast<unsigned>(result.allocationsPerOp));
+            ++regressions;
+        }
+        if (result.bytes > it->bytes) {
+            std::printf("REGRESSION %s: %u -> %u bytes\n", result.key.c_str(), static_cast<unsigned>(it->bytes),
+                        static_cast<unsigned>(result.bytes));
+            ++regressions;
+        }
+        if (tolerancePercent > 0 && result.nsPerOp > it->nsPerOp * (1.0 + tolerancePercent / 100.0)) {
+            std::printf("REGRESSION %s: %.0f -> %.0f ns (+%.0f%%)\n", result.key.c_str(), it->nsPerOp,
+                        result.nsPerOp, 100.0 * (result.nsPerOp / it->nsPerOp - 1.0));
+            ++regressions;
+        }
+    }
+    return regressions;
+}
+
+} // namespace
+
+int runStorageStress(int argc, char** argv) {
+    const long parsed = argc >= 3 ? std::strtol(argv[2], nullptr, 10) : 2;
+    const auto duration = std::chrono::seconds(parsed > 0 ? parsed : 2);
+
+    // the worker task never returns, so the storage it writes for stays alive until exit
+    auto* storage = new StorageService();
+    auto* worker = new PersistenceWorker(*storage);
+    worker->begin();
+    worker->setPolicy({5, 20});
+    std::atomic<uint32_t> nextSeed{0};
+    for (int i = 0; i < 16; ++i) {
+        storage->addExercise(stressExercise(nextSeed++));
+    }
+    storage->compact();
+    // commits write without the worker lock; slow writes make edits land in the middle of one
+    Preferences::setWriteDelayUs(100);
+    xTaskCreate(runPersistenceTask, "PersistenceTask", 4096, worker, 1, nullptr);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint32_t> errors{0};
+    std::atomic<uint64_t> snapshots{0};
+    std::atomic<uint64_t> bodies{0};
+    std::atomic<uint32_t> writes{0};
+
+    // Display/timer pattern: walk every summary of one snapshot; every few passes load a body
+    // through a handle like START does, and through the snapshot like the button task does.
+    auto reader = [&](uint32_t id) {
+        std::mt19937 rng(id);
+        StorageService::ExerciseHandle handle{};
+        while (!stop) {
+            const StorageService::LibraryRef library = storage->library();
+            for (size_t slot = 0; slot < library->size(); ++slot) {
+                if (!stressSummaryValid(library->summaryAt(slot))) {
+                    ++errors;
+                }
+            }
+            ++snapshots;
+            if (library->size() == 0 || rng() % 4 != 0) {
+                continue;
+            }
+            const size_t slot = rng() % library->size();
+            const StorageService::ExerciseRef exercise = storage->exerciseAt(*library, slot);
+            if (!stressBodyMatches(library->summaryAt(slot), exercise.view())) {
+                ++errors;
+            }
+            if (handle.generation == 0) {
+                handle = library->handleFor(library->idAt(slot));
+            }
+            // resolve() takes its own, possibly newer snapshot; the exercise may be gone by then
+            const StorageService::ExerciseRef resolved = storage->resolve(handle);
+            if (resolved && !stressBodyValid(resolved.view())) {
+                ++errors;
+            }
+            bodies += 2;
+        }
+    };
+
+    // Web pattern: add, update or remove one exercise at a time through the worker
+    auto writer = [&]() {
+        std::mt19937 rng(99);
+        while (!stop) {
+            const StorageService::LibraryRef library = storage->library();
+            const size_t size = library->size();
+            const uint32_t choice = rng() % 3;
+            if (size < 8 || (choice == 0 && size < 32)) {
+                worker->modify([&](StorageService& target) { return target.addExercise(stressExercise(nextSeed++)); });
+            } else if (choice == 1) {
+                const StorageService::ExerciseId id = library->idAt(rng() % size);
+                worker->modify([&](StorageService& target) {
+                    return target.updateExercise(id, stressExercise(nextSeed++));
+                });
+            } else {
+                const StorageService::ExerciseId id = library->idAt(rng() % size);
+                worker->modify([&](StorageService& target) { return target.removeExercise(id); });
+            }
+            ++writes;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < 3; ++i) {
+        threads.emplace_back(reader, i + 1);
+    }
+    threads.emplace_back(writer);
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // whatever the readers saw last must also be what a reboot finds
+    worker->flush();
+    Preferences::setWriteDelayUs(0);
+    StorageService reloaded;
+    reloaded.loadPersistent();
+    const StorageService::LibraryRef expected = storage->library();
+    const StorageService::LibraryRef actual = reloaded.library();
+    bool persisted = expected->size() == actual->size();
+    for (size_t slot = 0; persisted && slot < expected->size(); ++slot) {
+        const ExerciseSummary summary = actual->summaryOf(expected->idAt(slot));
+        const StorageService::ExerciseRef body = reloaded.exerciseAt(*actual, slot);
+        persisted = summary && stressBodyMatches(actual->summaryAt(slot), body.view()) &&
+                    summary.name.size == expected->summaryAt(slot).name.size;
+    }
+
+    const PersistenceWorker::Stats stats = worker->stats();
+    std::printf("%llu snapshots, %llu body reads, %u writes in %u commits, %u errors, reload %s\n",
+                static_cast<unsigned long long>(snapshots.load()), static_cast<unsigned long long>(bodies.load()),
+                static_cast<unsigned>(writes.load()), static_cast<unsigned>(stats.commits),
+                static_cast<unsigned>(errors.load()), persisted ? "ok" : "MISMATCH");
+    return errors == 0 && persisted ? 0 : 1;
+}
+
+int runStorageCodec(int argc, char** argv) {
+    size_t maxExercises = 256;
+    uint32_t minMs = 20;
+    double tolerancePercent = 100;
+    const char* csvPath = nullptr;
+    const char* baselinePath = nullptr;
+    for (int arg = 2; arg + 1 < argc; arg += 2) {
+        if (std::strcmp(argv[arg], "--exercises") == 0) {
+            maxExercises = std::max<long>(1, std::strtol(argv[arg + 1], nullptr, 10));
+        } else if (std::strcmp(argv[arg], "--min-ms") == 0) {
+            minMs = static_cast<uint32_t>(std::max<long>(1, std::strtol(argv[arg + 1], nullptr, 10)));
+        } else if (std::strcmp(argv[arg], "--tolerance") == 0) {
+            tolerancePercent = std::strtod(argv[arg + 1], nullptr);
+        } else if (std::strcmp(argv[arg], "--csv") == 0) {
+            csvPath = argv[arg + 1];
+        } else if (std::strcmp(argv[arg], "--baseline") == 0) {
+            baselinePath = argv[arg + 1];
+        }
+    }
+    std::vector<CodecResult> baseline;
+    if (baselinePath && !readBaseline(baselinePath, baseline)) {
+        std::fprintf(stderr, "cannot read baseline %s\n", baselinePath);
+        return 2;
+    }
+
+    // savePersistent() and loadPersistent() log every call
+    nativeSetSerialMuted(true);
+    std::vector<CodecResult> results;
+    uint32_t mismatches = 0;
+    std::vector<StorageService::ExerciseId> lastIds;
+    for (size_t shape = 0; shape < sizeof(kCodecShapes) / sizeof(kCodecShapes[0]); ++shape) {
+        std::vector<size_t> sizes = {1, 8, 64};
+        sizes.erase(std::remove_if(sizes.begin(), sizes.end(), [&](size_t size) { return size >= maxExercises; }),
+                    sizes.end());
+        sizes.push_back(maxExercises);
+        for (size_t size : sizes) {
+            const char* name = kCodecShapes[shape];
+            std::vector<Exercise> exercises;
+            std::vector<std::vector<uint8_t>> bodies;
+            StorageService storage;
+            std::vector<StorageService::ExerciseId> ids;
+            for (size_t i = 0; i < size; ++i) {
+                exercises.push_back(codecExercise(shape, i));
+                bodies.emplace_back();
+                ExerciseView::encode(bodies.back(), exercises.back());
+                StorageService::ExerciseId id{};
+                storage.addExercise(exercises.back(), &id);
+                ids.push_back(id);
+            }
+            storage.compact();
+
+            // Exercise -> body (ExerciseView::encode), as putExercise() does for every change
+            const auto encode = [&] {
+                size_t bytes = 0;
+                for (const Exercise& exercise : exercises) {
+                    std::vector<uint8_t> body;
+                    ExerciseView::encode(body, exercise);
+                    bytes += body.size();
+                }
+                return bytes;
+            };
+            // body -> checked against the limits -> editable Exercise
+            const auto decode = [&] {
+                size_t bytes = 0;
+                for (const std::vector<uint8_t>& body : bodies) {
+                    const size_t length = ExerciseView::measure(body.data(), body.size(), StorageService::kMaxSets,
+                                                                StorageService::kMaxRepsPerSet,
+                                                                StorageService::kMaxExerciseNameLength,
+                                                                StorageService::kMaxSetLabelLength);
+                    const Exercise exercise = ExerciseView(body.data(), length).toExercise();
+                    g_sink = g_sink + exercise.sets.size();
+                    bytes += length;
+                }
+                return bytes;
+            };
+            // serialize() of the index snapshot, written through the NVS shim by compact()
+            const auto snapshotEncode = [&] {
+                storage.compact();
+                return snapshotBytes();
+            };
+            // deserialize() at boot: read the snapshot and publish the index, bodies stay in NVS
+            const auto snapshotDecode = [&] {
+                StorageService loaded;
+                loaded.loadPersistent();
+                g_sink = g_sink + loaded.library()->size();
+                return snapshotBytes();
+            };
+
+            for (size_t i = 0; i < size; ++i) {
+                const Exercise decoded = ExerciseView(bodies[i].data(), bodies[i].size()).toExercise();
+                mismatches += sameExercise(decoded, exercises[i]) ? 0 : 1;
+            }
+            {
+                StorageService loaded;
+                loaded.loadPersistent();
+                const StorageService::LibraryRef library = loaded.library();
+                mismatches += library->size() == size ? 0 : 1;
+                for (size_t i = 0; i < size && i < library->size(); ++i) {
+                    const StorageService::ExerciseRef body = loaded.find(ids[i]);
+                    mismatches += body && sameExercise(body->toExercise(), exercises[i]) ? 0 : 1;
+                }
+            }
+
+            measureCodec(name, size,
+                         {{"encode", encode},
+                          {"decode", decode},
+                          {"roundtrip", [&] { return encode() + decode(); }},
+                          {"snapshot-encode", snapshotEncode},
+                          {"snapshot-decode", snapshotDecode},
+                          {"snapshot-roundtrip", [&] { return snapshotEncode() + snapshotDecode(); }}},
+                         minMs, results);
+            lastIds = ids;
+        }
+    }
+
+    // Ids as the web handlers pass them around
+    std::vector<String> hex;
+    for (const StorageService::ExerciseId& id : lastIds) {
+        hex.push_back(StorageService::toHex(id));
+        mismatches += StorageService::fromHex(hex.back()) == id ? 0 : 1;
+    }
+    const auto toHex = [&] {
+        size_t bytes = 0;
+        for (const StorageService::ExerciseId& id : lastIds) {
+            bytes += StorageService::toHex(id).length();
+        }
+        return bytes;
+    };
+    const auto fromHex = [&] {
+        size_t bytes = 0;
+        for (const String& text : hex) {
+            g_sink = g_sink + StorageService::fromHex(text)[0];
+            bytes += text.length();
+        }
+        return bytes;
+    };
+    measureCodec("ids", lastIds.size(),
+                 {{"toHex", toHex}, {"fromHex", fromHex}, {"roundtrip", [&] { return toHex() + fromHex(); }}}, minMs,
+                 results);
+    nativeSetSerialMuted(false);
+
+    std::printf("%-6s %10s %-19s %14s %10s %10s %10s\n", "case", "exercises", "op", "ns/op", "MB/s", "new/op",
+                "bytes");
+    for (const CodecResult& result : results) {
+        char name[32];
+        char op[32];
+        unsigned exercises = 0;
+        std::sscanf(result.key.c_str(), "%31[^,],%u,%31s", name, &exercises, op);
+        std::printf("%-6s %10u %-19s %14.0f %10.1f %10u %10u\n", name, exercises, op, result.nsPerOp, result.mbPerS,
+                    static_cast<unsigned>(result.allocationsPerOp), static_cast<unsigned>(result.bytes));
+    }
+    if (csvPath) {
+        std::FILE* file = std::fopen(csvPath, "w");
+        if (!file) {
+            std::fprintf(stderr, "cannot write %s\n", csvPath);
+            return 2;
+        }
+        std::fprintf(file, "case,exercises,op,ns_per_op,mb_per_s,allocs_per_op,bytes\n");
+        for (const CodecResult& result : results) {
+            std::fprintf(file, "%s,%.0f,%.1f,%u,%u\n", result.key.c_str(), result.nsPerOp, result.mbPerS,
+                         static_cast<unsigned>(result.allocationsPerOp), static_cast<unsigned>(result.bytes));
+        }
+        std::fclose(file);
+    }
+    if (mismatches > 0) {
+        std::printf("%u exercises did not survive the round trip\n", static_cast<unsigned>(mismatches));
+        return 1;
+    }
+    if (baselinePath) {
+        const uint32_t regressions = reportRegressions(results, baseline, tolerancePercent);
+        std::printf("%u regressions against %s (time tolerance %.0f%%)\n", static_cast<unsigned>(regressions),
+                    baselinePath, tolerancePercent);
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
+
+int runStorageBench(int argc, char** argv) {
+    if (std::strcmp(argv[1], "--storage-stress") == 0) {
+        return runStorageStress(argc, argv);
+    }
+    if (std::strcmp(argv[1], "--storage-codec") == 0) {
+        return runStorageCodec(argc, argv);
+    }
+    const long parsed = argc >= 3 ? std::strtol(argv[2], nullptr, 10) : 200000;
+    const uint32_t lookups = parsed > 0 ? static_cast<uint32_t>(parsed) : 200000;
+
+    std::printf("%10s %14s %14s %14s %14s\n", "exercises", "linear ns", "index ns", "handle ns", "snapshot ns");
+    for (size_t size : {8u, 32u, 128u, 512u}) {
+        StorageService storage;
+        std::vector<StorageService::ExerciseId> ids;
+        for (size_t i = 0; i < size; ++i) {
+            StorageService::ExerciseId id{};
+            storage.addExercise(makeExercise(i), &id);
+            ids.push_back(id);
+        }
+
+        const StorageService::LibraryRef library = storage.library();
+        // Linear scan as findExercise() did before the index
+        const double linear = nsPerLookup(ids, lookups, [&](const StorageService::ExerciseId& id) {
+            for (size_t slot = 0; slot < library->size(); ++slot) {
+                if (library->idAt(slot) == id) {
+                    return library->summaryAt(slot);
+                }
+            }
+            return ExerciseSummary{};
+        });
+        const double indexed = nsPerLookup(ids, lookups, [&](const StorageService::ExerciseId& id) {
+            return library->summaryOf(id);
+        });
+        // Timer task pattern: one handle resolved again and again
+        StorageService::ExerciseHandle handle = library->handleFor(ids[size / 2]);
+        const double handled = nsPerLookup(ids, lookups, [&](const StorageService::ExerciseId&) {
+            return library->resolveSummary(handle);
+        });
+        // The same with a fresh snapshot per lookup, as the IDLE screen does on every pass. The
+        // summary points into the released snapshot, which stays alive since nothing is written.
+        const double snapshot = nsPerLookup(ids, lookups, [&](const StorageService::ExerciseId&) {
+            return storage.library()->resolveSummary(handle);
+        });
+
+        std::printf("%10u %14.1f %14.1f %14.1f %14.1f\n", static_cast<unsigned>(size), linear, indexed, handled,
+                    snapshot);
+    }
+
+    constexpr uint32_t kEdits = 200;
+    std::printf("\n%10s %14s %14s\n", "exercises", "rewrite B/edit", "journal B/edit");
+    for (size_t size : {8u, 32u, 128u, 512u}) {
+        const double rewrite = bytesPerEdit(size, kEdits, true);
+        const double journal = bytesPerEdit(size, kEdits, false);
+        std::printf("%10u %14.1f %14.1f\n", static_cast<unsigned>(size), rewrite, journal);
+    }
+
+    std::printf("\n%-22s %8s %8s %9s\n", "library", "v1 B", "v3 B", "saved");
+    reportFormat("8 x 1 set x 6 reps", 8, 1, 6);
+    reportFormat("16 x 3 sets x 6 reps", 16, 3, 6);
+    reportFormat("16 x 5 sets x 30 reps", 16, 5, 30);
+    reportFormat("64 x 15 sets x 30 reps", 64, 15, 30);
+
+    // heap in bytes held by the storage after boot and after viewing every exercise once
+    std::printf("\n%10s %10s %10s %10s %10s %10s %10s %10s\n", "exercises", "boot us", "boot new", "boot B",
+                "browsed B", "library B", "cold us", "cached us");
+    for (size_t size : {8u, 32u, 128u, 512u}) {
+        reportBoot(size);
+    }
+
+    // heap traffic of one save from the web form; retained B is the same for both
+    std::printf("\n%-26s %10s %10s %10s %10s %10s\n", "web save", "graph new", "graph pk B", "build new",
+                "build pk B", "retained B");
+    reportWebSave("add 1 set x 6 reps", 1, 6, false);
+    reportWebSave("add 5 sets x 10 reps", 5, 10, false);
+    reportWebSave("add 15 sets x 30 reps", 15, 30, false);
+    reportWebSave("update 5 sets x 10 reps", 5, 10, true);
+
+#ifdef MODEL_FIXED_CAPACITY
+    const char* modelTypes = "fixed capacity";
+#else
+    const char* modelTypes = "std::string/std::vector";
+#endif
+    // Exercise/Set/Rep on the heap; the sizes of the fixed-capacity objects do not depend on the content
+    std::printf("\nmodel types: %s, sizeof Rep %u, sizeof ExerciseTimeline %u\n", modelTypes,
+                static_cast<unsigned>(sizeof(Rep)), static_cast<unsigned>(sizeof(ExerciseTimeline)));
+    std::printf("%-22s %10s %10s %10s %10s %10s\n", "model", "sizeof", "copy new", "copy B", "timeline new",
+                "timeline B");
+    reportModel("1 set x 6 reps", 1, 6);
+    reportModel("5 sets x 10 reps", 5, 10);
+    reportModel("15 sets x 30 reps", 15, 30);
+
+    // 20 edits 10 ms apart; the short windows keep the run brief (firmware default 1000/5000 ms)
+    std::printf("\n%-24s %8s %10s %12s %12s %12s\n", "persistence", "commits", "NVS B", "handler us",
+                "max hndl us", "latency ms");
+    reportWriteBehind("sync per edit", 0, 0, 20, 10);
+    reportWriteBehind("write-behind 50/500 ms", 50, 500, 20, 10);
+    reportWriteBehind("write-behind 50/80 ms", 50, 80, 20, 10);
+    reportWriteBehind("50/80 ms, 20 ms flash", 50, 80, 20, 10, 20);
+    reportWriteBehind("500/5000 ms, flush request", 500, 5000, 20, 10, 0, true);
+    return 0;
+}
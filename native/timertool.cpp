@@ -0,0 +1,818 @@
+// Host-only timer tool: drives the firmware's timer task (timerStep() in core/main.cpp) on a
+// simulated clock through TimerScheduler::setClock(), so a whole exercise runs in milliseconds.
+//
+//   program --timer-wakeups             counts the timer task's wakeups for a few exercises and
+//                                       exits 1 if one of them neither drew a frame nor changed
+//                                       state, if a session ends off its ideal duration, if
+//                                       a pause still wakes the task, or if closing "Fertig!"
+//                                       early loses the selection
+//   program --timer-drift [sessions]    random exercises with random wake latency; reports how far
+//                                       each session's end lands from its nominal length, next to
+//                                       the drift of restarting every phase when it is observed,
+//                                       and exits 1 if lateness accumulated beyond one wakeup
+//   program --timer-alloc               counts heap allocations (operator new, see storagebench.cpp)
+//                                       from START until "Fertig!", countdown frames, set summaries
+//                                       and a pause included; exits 1 if there was any
+//   program --timer-jitter [reps]       real time, not simulated: one session of 1 s hangs and
+//                                       rests per configuration, with the I2C transfer modelled at
+//                                       100 and 400 kHz (nativeSetI2cClock()) and the frame drawn
+//                                       either in the timer task or in the display task. Reports
+//                                       how late the timer task woke for phase transitions and
+//                                       for all deadlines.
+//   program --timer-budget [us]         full workouts on the simulated clock, but each timer step
+//                                       takes its real time; exits 1 if TimerScheduler::maxLoopUs()
+//                                       exceeds the budget (default 5000 us)
+//   program --timer-commands [seconds]  producers on several threads post numbered commands into
+//                                       one CommandBus, a consumer task drains it; exits 1 if an
+//                                       accepted command is lost, arrives twice or out of its
+//                                       producer's order, or if posted()/dropped() disagree.
+//                                       Build with -fsanitize=thread to check the memory side.
+//   program --timer-timeline            compiles exercises of several shapes into ExerciseTimelines
+//                                       and compares phases, start times and durations with the
+//                                       expected sequence (no rest after a set's last rep, no set
+//                                       pause after the last set); exits 1 on a difference
+
+#include "core/globals.h"
+#include "core/timebase.h"
+#include "models/timeline.h"
+
+#include <U8g2lib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern std::atomic<ExerciseState> E;
+uint32_t timerStep();
+size_t nativeAllocationCount();
+
+namespace {
+
+// Simulated clock: waitFor() returns immediately and moves the time to the deadline, plus
+// g_wakeLatencyUs like a task that is scheduled late.
+uint64_t g_simUs = 0;
+uint32_t g_wakeLatencyUs = 0;
+
+uint64_t simNow() { return g_simUs; }
+
+bool simWait(uint32_t timeoutMs) {
+    if (timeoutMs == TimerScheduler::kForever) {
+        return true; // only a command wakes the task; the tool posts it right after
+    }
+    g_simUs += static_cast<uint64_t>(timeoutMs) * 1000ULL + g_wakeLatencyUs;
+    return false;
+}
+
+struct Scenario {
+    const char* name;
+    Exercise exercise;
+};
+
+Exercise makeExercise(const char* name, int sets, int reps, int hang, int rest, int setPause) {
+    Exercise exercise(name);
+    for (int s = 0; s < sets; ++s) {
+        Set set("S", setPause, 80);
+        for (int r = 0; r < reps; ++r) {
+            set.reps.emplace_back(hang, rest);
+        }
+        exercise.sets.push_back(set);
+    }
+    return exercise;
+}
+
+// Clock for --timer-budget: waits are simulated, the time between two waits is real, so
+// TimerScheduler::maxLoopUs() sees how long a timer step really takes.
+uint64_t g_realAtWakeUs = 0;
+
+uint64_t budgetNow() { return g_simUs + (monotonicMicros() - g_realAtWakeUs); }
+
+bool budgetWait(uint32_t timeoutMs) {
+    g_simUs = budgetNow();
+    const bool notified = simWait(timeoutMs);
+    g_realAtWakeUs = monotonicMicros();
+    return notified;
+}
+
+// Real clock for --timer-jitter: sleeps the full timeout, commands are handled as in simWait()
+bool realWait(uint32_t timeoutMs) {
+    if (timeoutMs == TimerScheduler::kForever) {
+        return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    return false;
+}
+
+// Selects and starts the exercise; the preload of its body runs here instead of the
+// persistence task. Returns the wait of the first timer step, or kForever on failure.
+// startUs, if given, receives the clock right before START, i.e. about the session epoch.
+uint32_t startSession(const Exercise& exercise, StorageService::ExerciseId& id, uint64_t* startUs = nullptr) {
+    if (!storageService.addExercise(exercise, &id)) {
+        return TimerScheduler::kForever;
+    }
+    Command select;
+    select.type = CommandType::SELECT;
+    select.exerciseId = id;
+    commandBus.post(select);
+    timerStep();
+    persistenceWorker.poll(g_simUs);
+
+    if (startUs) {
+        *startUs = timerScheduler.nowUs();
+    }
+    commandBus.post(CommandType::START);
+    uint32_t waitMs = timerStep();
+    for (int attempt = 0; attempt < 3 && E != ExerciseState::STARTED; ++attempt) {
+        persistenceWorker.poll(g_simUs);
+        waitMs = timerStep();
+    }
+    return E == ExerciseState::STARTED ? waitMs : TimerScheduler::kForever;
+}
+
+struct SessionResult {
+    uint32_t wakeups = 0;
+    uint32_t idleWakeups = 0; // neither a new frame nor a state change
+    uint32_t frames = 0;
+    uint64_t sessionUs = 0;   // START until the "Fertig!" screen
+    uint64_t idealUs = 0;
+    ExerciseTimeline timeline;
+};
+
+// Runs one session from START back to IDLE. latency() gives the lateness in us of the next
+// wakeup, onWakeup(sinceStartUs) sees every wakeup after its timer step.
+template <typename Latency, typename OnWakeup>
+bool runSession(const Exercise& exercise, SessionResult& result, Latency latency, OnWakeup onWakeup) {
+    StorageService::ExerciseId id;
+    const uint64_t startUs = g_simUs;
+    uint32_t waitMs = startSession(exercise, id);
+    if (waitMs == TimerScheduler::kForever) {
+        return false;
+    }
+    result.timeline.build(storageService.find(id).view());
+    result.idealUs = static_cast<uint64_t>(result.timeline.totalMs()) * 1000ULL;
+    timerScheduler.resetStats();
+    displayService.resetStats();
+
+    while (E != ExerciseState::IDLE && waitMs != TimerScheduler::kForever) {
+        g_wakeLatencyUs = latency();
+        timerScheduler.waitFor(waitMs);
+        const uint32_t framesBefore = displayService.stats().framesRendered;
+        const ExerciseState stateBefore = E;
+        waitMs = timerStep();
+        if (displayService.stats().framesRendered == framesBefore && E == stateBefore) {
+            ++result.idleWakeups;
+        }
+        if (E == ExerciseState::FINISHED && result.sessionUs == 0) {
+            result.sessionUs = g_simUs - startUs;
+        }
+        onWakeup(g_simUs - startUs);
+    }
+    g_wakeLatencyUs = 0;
+    result.wakeups = timerScheduler.wakeups();
+    result.frames = displayService.stats().framesRendered;
+    storageService.removeExercise(id);
+    return E == ExerciseState::IDLE;
+}
+
+// A paused session must sleep until RESUME, and resuming must not lose or add time.
+bool checkPause() {
+    StorageService::ExerciseId id;
+    const uint64_t startUs = g_simUs;
+    uint32_t waitMs = startSession(makeExercise("Pause", 1, 2, 5, 3, 0), id);
+    const uint64_t idealUs = static_cast<uint64_t>(ExerciseTimeline::durationMs(storageService.find(id).view())) * 1000ULL;
+    for (int step = 0; step < 5 && waitMs != TimerScheduler::kForever; ++step) {
+        timerScheduler.waitFor(waitMs);
+        waitMs = timerStep();
+    }
+    commandBus.post(CommandType::PAUSE);
+    timerScheduler.resetStats();
+    const bool slept = timerStep() == TimerScheduler::kForever && E == ExerciseState::PAUSED;
+    const uint64_t pauseUs = 60ULL * 1000000ULL;
+    g_simUs += pauseUs; // a minute on the PAUSE screen
+    commandBus.post(CommandType::RESUME);
+    timerScheduler.waitFor(TimerScheduler::kForever);
+    const bool notified = timerScheduler.notifiedWakeups() == 1;
+    waitMs = timerStep();
+    uint64_t sessionUs = 0;
+    while (E != ExerciseState::IDLE && waitMs != TimerScheduler::kForever) {
+        timerScheduler.waitFor(waitMs);
+        waitMs = timerStep();
+        if (E == ExerciseState::FINISHED && sessionUs == 0) {
+            sessionUs = g_simUs - startUs;
+        }
+    }
+    storageService.removeExercise(id);
+    const bool onTime = sessionUs == idealUs + pauseUs;
+    std::printf("pause: %s, resume %s, session %.3f s for %.3f s + 60 s pause\n", slept ? "sleeps" : "WAKES",
+                notified ? "by notify" : "NOT NOTIFIED", sessionUs / 1e6, idealUs / 1e6);
+    return slept && notified && onTime;
+}
+
+// Closing "Fertig!" early (DISMISS, a button press) must leave the exercise selected like the
+// timeout does, so the next START runs it again.
+bool checkFinishedScreen() {
+    bool ok = true;
+    for (const bool dismiss : {false, true}) {
+        StorageService::ExerciseId id;
+        uint32_t waitMs = startSession(makeExercise("Finish", 1, 1, 1, 0, 0), id);
+        while (E != ExerciseState::FINISHED && waitMs != TimerScheduler::kForever) {
+            timerScheduler.waitFor(waitMs);
+            waitMs = timerStep();
+        }
+        if (dismiss) {
+            commandBus.post(CommandType::DISMISS);
+        }
+        while (E != ExerciseState::IDLE && waitMs != TimerScheduler::kForever) {
+            timerScheduler.waitFor(waitMs);
+            waitMs = timerStep();
+        }
+        commandBus.post(CommandType::START);
+        timerStep();
+        const bool selected = E == ExerciseState::STARTED;
+        commandBus.post(CommandType::STOP);
+        timerStep();
+        timerStep();
+        storageService.removeExercise(id);
+        std::printf("finished screen %s: %s\n", dismiss ? "dismissed" : "timed out",
+                    selected ? "exercise still selected" : "SELECTION LOST");
+        ok = ok && selected && E == ExerciseState::IDLE;
+    }
+    return ok;
+}
+
+int runTimerWakeups() {
+    const Scenario scenarios[] = {
+        {"7/3 x6, 3 sets", makeExercise("Repeaters", 3, 6, 7, 3, 120)},
+        {"10 s hangs x5", makeExercise("Max hangs", 1, 5, 10, 180, 0)},
+        {"1 s / 0 s x30", makeExercise("Short", 2, 30, 1, 0, 5)},
+    };
+    bool ok = true;
+    std::printf("%-16s %10s %8s %8s %8s %12s %12s\n", "exercise", "latency", "wakeups", "idle", "frames",
+                "session s", "ideal s");
+    for (const uint32_t latencyUs : {0u, 3000u}) {
+        for (const Scenario& scenario : scenarios) {
+            SessionResult result;
+            const bool finished = runSession(
+                scenario.exercise, result, [&] { return latencyUs; }, [](uint64_t) {});
+            // Late wakeups may shift the end by one latency, never by more
+            const bool onTime = result.sessionUs >= result.idealUs && result.sessionUs <= result.idealUs + latencyUs;
+            std::printf("%-16s %8u us %8u %8u %8u %12.3f %12.3f%s\n", scenario.name, static_cast<unsigned>(latencyUs),
+                        static_cast<unsigned>(result.wakeups), static_cast<unsigned>(result.idleWakeups),
+                        static_cast<unsigned>(result.frames), result.sessionUs / 1e6, result.idealUs / 1e6,
+                        finished && onTime && result.idleWakeups == 0 ? "" : "  FAIL");
+            ok = ok && finished && onTime && result.idleWakeups == 0;
+        }
+    }
+    ok = checkPause() && ok;
+    ok = checkFinishedScreen() && ok;
+    return ok ? 0 : 1;
+}
+
+// Sum of the lateness at every phase end, i.e. the drift if each phase restarted from the
+// moment its start was observed instead of from the session epoch
+uint64_t restartDriftUs(const ExerciseTimeline& timeline, const std::vector<uint64_t>& wakeUs) {
+    uint64_t drift = 0;
+    auto wake = wakeUs.begin();
+    for (size_t phase = 1; phase <= timeline.size(); ++phase) {
+        const uint64_t boundaryUs = static_cast<uint64_t>(timeline.phaseEndMs(phase - 1)) * 1000ULL;
+        wake = std::lower_bound(wake, wakeUs.end(), boundaryUs);
+        if (wake == wakeUs.end()) {
+            break;
+        }
+        drift += *wake - boundaryUs;
+    }
+    return drift;
+}
+
+double percentile(std::vector<uint64_t> values, double fraction) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return static_cast<double>(values[static_cast<size_t>(fraction * (values.size() - 1))]);
+}
+
+int runTimerDrift(uint32_t sessions) {
+    std::mt19937 rng(7);
+    auto pick = [&](int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); };
+    // Mostly a few hundred us like a busy tick, now and then a 10-20 ms stall (flash, WiFi)
+    const uint32_t kMaxLatencyUs = 20000;
+    auto latency = [&] {
+        return pick(0, 99) == 0 ? static_cast<uint32_t>(pick(10000, kMaxLatencyUs)) : static_cast<uint32_t>(pick(0, 800));
+    };
+
+    std::vector<uint64_t> driftUs;
+    std::vector<uint64_t> restartUs;
+    std::vector<uint64_t> wakeUs;
+    uint64_t nominalUs = 0;
+    uint64_t totalWakeups = 0;
+    bool ok = true;
+    for (uint32_t session = 0; session < sessions; ++session) {
+        // Every tenth session is a 45-minute protocol, the rest random shapes
+        const Exercise exercise = session % 10 == 0
+                                      ? makeExercise("Protocol", 6, 6, 7, 53, 150)
+                                      : makeExercise("Random", pick(1, 6), pick(1, 10), pick(3, 10), pick(0, 60), pick(30, 300));
+        SessionResult result;
+        wakeUs.clear();
+        if (!runSession(exercise, result, latency, [&](uint64_t sinceStartUs) { wakeUs.push_back(sinceStartUs); })) {
+            std::printf("session %u did not finish\n", static_cast<unsigned>(session));
+            return 1;
+        }
+        const uint64_t drift = result.sessionUs - result.idealUs;
+        // The end is seen one late wakeup after it is due; anything beyond that accumulated
+        if (result.sessionUs < result.idealUs || drift > kMaxLatencyUs) {
+            ok = false;
+        }
+        driftUs.push_back(drift);
+        restartUs.push_back(restartDriftUs(result.timeline, wakeUs));
+        nominalUs += result.idealUs;
+        totalWakeups += result.wakeups;
+    }
+
+    std::printf("%u sessions, %.1f h nominal, %llu wakeups, wake latency 0-800 us, 1 %% 10-20 ms\n",
+                static_cast<unsigned>(sessions), nominalUs / 3.6e9, static_cast<unsigned long long>(totalWakeups));
+    std::printf("%-24s %10s %10s %10s %10s\n", "end of session vs nominal", "mean ms", "p50 ms", "p99 ms", "max ms");
+    for (const auto& row : {std::make_pair("session epoch", &driftUs), std::make_pair("restart per phase", &restartUs)}) {
+        const std::vector<uint64_t>& values = *row.second;
+        double sum = 0;
+        for (const uint64_t value : values) {
+            sum += static_cast<double>(value);
+        }
+        std::printf("%-24s %10.3f %10.3f %10.3f %10.3f\n", row.first, sum / values.size() / 1000.0,
+                    percentile(values, 0.5) / 1000.0, percentile(values, 0.99) / 1000.0,
+                    percentile(values, 1.0) / 1000.0);
+    }
+    if (!ok) {
+        std::printf("FAIL: a session ended more than one wakeup latency after its nominal length\n");
+    }
+    return ok ? 0 : 1;
+}
+
+int runTimerAlloc() {
+    const Scenario scenarios[] = {
+        {"7/3 x6, 3 sets", makeExercise("Repeaters", 3, 6, 7, 3, 120)},
+        {"1 s / 0 s x30", makeExercise("Short", 2, 30, 1, 0, 5)},
+    };
+    bool ok = true;
+    std::printf("%-16s %8s %8s %12s\n", "exercise", "wakeups", "frames", "allocations");
+    for (const Scenario& scenario : scenarios) {
+        // Counted from the first wait after START (building the timeline may allocate) until
+        // the step that shows "Fertig!"; halfway through, the session is paused and resumed.
+        size_t before = 0;
+        size_t after = 0;
+        bool counting = false;
+        bool paused = false;
+        SessionResult result;
+        const bool finished = runSession(
+            scenario.exercise, result,
+            [&] {
+                if (!counting && after == 0) {
+                    before = nativeAllocationCount();
+                    counting = true;
+                }
+                return 0u;
+            },
+            [&](uint64_t sinceStartUs) {
+                if (!paused && sinceStartUs * 2 >= result.idealUs) {
+                    paused = true;
+                    commandBus.post(CommandType::PAUSE);
+                    timerStep();
+                    commandBus.post(CommandType::RESUME);
+                    timerStep();
+                }
+                if (counting && E != ExerciseState::STARTED) {
+                    after = nativeAllocationCount();
+                    counting = false;
+                }
+            });
+        const size_t allocations = after - before;
+        std::printf("%-16s %8u %8u %12zu%s\n", scenario.name, static_cast<unsigned>(result.wakeups),
+                    static_cast<unsigned>(result.frames), allocations, finished && allocations == 0 ? "" : "  FAIL");
+        ok = ok && finished && allocations == 0;
+    }
+    return ok ? 0 : 1;
+}
+
+int runTimerBudget(uint32_t budgetUs) {
+    g_realAtWakeUs = monotonicMicros();
+    timerScheduler.setClock(budgetNow, budgetWait);
+    const Scenario scenarios[] = {
+        {"7/3 x6, 3 sets", makeExercise("Repeaters", 3, 6, 7, 3, 120)},
+        {"10 s hangs x5", makeExercise("Max hangs", 1, 5, 10, 180, 0)},
+        {"1 s / 0 s x30", makeExercise("Short", 2, 30, 1, 0, 5)},
+        {"45 min protocol", makeExercise("Protocol", 6, 6, 7, 53, 150)},
+    };
+    bool ok = true;
+    std::printf("%-16s %8s %12s %12s\n", "exercise", "wakeups", "max loop us", "budget us");
+    for (const Scenario& scenario : scenarios) {
+        SessionResult result;
+        const bool finished = runSession(
+            scenario.exercise, result, [] { return 0u; }, [](uint64_t) {});
+        const uint32_t maxLoopUs = timerScheduler.maxLoopUs();
+        const bool withinBudget = maxLoopUs <= budgetUs;
+        std::printf("%-16s %8u %12u %12u%s\n", scenario.name, static_cast<unsigned>(result.wakeups),
+                    static_cast<unsigned>(maxLoopUs), static_cast<unsigned>(budgetUs),
+                    finished && withinBudget ? "" : "  FAIL");
+        ok = ok && finished && withinBudget;
+    }
+    return ok ? 0 : 1;
+}
+
+// --timer-commands: the exercise id carries producer and sequence number of each command
+constexpr size_t kCommandProducers = 4;
+constexpr uint32_t kCommandTypes = static_cast<uint32_t>(CommandType::DISMISS) + 1;
+
+struct CommandStress {
+    CommandBus bus;
+    std::atomic<bool> producersDone{false};
+    std::atomic<bool> consumerDone{false};
+    std::atomic<TaskHandle_t> consumer{nullptr};
+    std::vector<uint32_t> received[kCommandProducers]; // only the consumer writes
+    uint32_t malformed = 0;
+};
+
+Command numberedCommand(uint32_t producer, uint32_t sequence) {
+    Command command;
+    command.type = static_cast<CommandType>(sequence % kCommandTypes);
+    command.exerciseId[0] = static_cast<uint8_t>(producer);
+    std::memcpy(&command.exerciseId[1], &sequence, sizeof(sequence));
+    command.exerciseId[15] = static_cast<uint8_t>(~producer);
+    return command;
+}
+
+void commandConsumer(void* parameter) {
+    CommandStress& stress = *static_cast<CommandStress*>(parameter);
+    stress.bus.attach();
+    stress.consumer.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+    for (;;) {
+        // producersDone before the last drain, so nothing posted earlier is left behind
+        const bool last = stress.producersDone.load(std::memory_order_acquire);
+        Command command;
+        while (stress.bus.poll(command)) {
+            const uint32_t producer = command.exerciseId[0];
+            uint32_t sequence = 0;
+            std::memcpy(&sequence, &command.exerciseId[1], sizeof(sequence));
+            if (producer >= kCommandProducers || command.exerciseId[15] != static_cast<uint8_t>(~producer) ||
+                command.type != static_cast<CommandType>(sequence % kCommandTypes)) {
+                ++stress.malformed;
+                continue;
+            }
+            stress.received[producer].push_back(sequence);
+        }
+        if (last) {
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, 1);
+    }
+    stress.consumerDone.store(true, std::memory_order_release);
+}
+
+int runTimerCommands(uint32_t seconds) {
+    CommandStress stress;
+    xTaskCreate(commandConsumer, "CommandConsumer", 2048, &stress, 2, nullptr);
+    while (!stress.consumer.load(std::memory_order_acquire)) {
+        delay(1);
+    }
+
+    std::vector<uint8_t> accepted[kCommandProducers]; // accepted[p][seq], only producer p writes
+    std::vector<std::thread> producers;
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    for (uint32_t producer = 0; producer < kCommandProducers; ++producer) {
+        producers.emplace_back([&, producer] {
+            std::vector<uint8_t>& mine = accepted[producer];
+            for (uint32_t sequence = 0; std::chrono::steady_clock::now() < until; ++sequence) {
+                const bool ok = stress.bus.post(numberedCommand(producer, sequence));
+                mine.push_back(ok ? 1 : 0);
+                if (!ok) {
+                    std::this_thread::yield(); // full: give the consumer a chance, like a button task would
+                }
+            }
+        });
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    stress.producersDone.store(true, std::memory_order_release);
+    xTaskNotifyGive(stress.consumer.load(std::memory_order_acquire));
+    while (!stress.consumerDone.load(std::memory_order_acquire)) {
+        delay(1);
+    }
+
+    uint64_t acceptedTotal = 0;
+    uint64_t rejectedTotal = 0;
+    uint64_t lost = 0;
+    uint64_t unexpected = 0; // duplicates, reordering or commands that were never accepted
+    for (size_t producer = 0; producer < kCommandProducers; ++producer) {
+        const std::vector<uint32_t>& got = stress.received[producer];
+        size_t next = 0;
+        for (uint32_t sequence = 0; sequence < accepted[producer].size(); ++sequence) {
+            if (!accepted[producer][sequence]) {
+                ++rejectedTotal;
+                continue;
+            }
+            ++acceptedTotal;
+            if (next < got.size() && got[next] == sequence) {
+                ++next;
+            } else {
+                ++lost;
+            }
+        }
+        unexpected += got.size() - std::min(got.size(), next);
+    }
+    const bool statsMatch = stress.bus.posted() == static_cast<uint32_t>(acceptedTotal) &&
+                            stress.bus.dropped() == static_cast<uint32_t>(rejectedTotal);
+    std::printf("%u producers, %u s: %llu accepted, %llu rejected (queue full), %llu lost, %llu duplicated or out of "
+                "order, %u malformed, posted()/dropped() %s\n",
+                static_cast<unsigned>(kCommandProducers), static_cast<unsigned>(seconds),
+                static_cast<unsigned long long>(acceptedTotal), static_cast<unsigned long long>(rejectedTotal),
+                static_cast<unsigned long long>(lost), static_cast<unsigned long long>(unexpected),
+                static_cast<unsigned>(stress.malformed), statsMatch ? "match" : "DIFFER");
+    return lost == 0 && unexpected == 0 && stress.malformed == 0 && statsMatch ? 0 : 1;
+}
+
+// The phases an exercise should play, straight from the model: get ready, then hang and rest
+// for every rep but without the rest after the last one, and a set pause between sets only.
+// Phases without duration are left out, as ExerciseTimeline::build() does.
+std::vector<TimelinePhase> expectedPhases(const Exercise& exercise, uint32_t& totalMs) {
+    std::vector<TimelinePhase> phases;
+    totalMs = 0;
+    auto add = [&](RepState phase, size_t set, size_t rep, uint32_t durationMs) {
+        if (durationMs == 0) {
+            return;
+        }
+        TimelinePhase entry;
+        entry.startMs = totalMs;
+        entry.phase = phase;
+        entry.setIndex = static_cast<uint8_t>(set);
+        entry.repIndex = static_cast<uint8_t>(rep);
+        phases.push_back(entry);
+        totalMs += durationMs;
+    };
+    for (size_t set = 0; set < exercise.sets.size(); ++set) {
+        const Set& current = exercise.sets[set];
+        add(RepState::PRE, set, 0, ExerciseTimeline::kPreparationMs);
+        for (size_t rep = 0; rep < current.reps.size(); ++rep) {
+            add(RepState::IN_PROGRESS, set, rep, current.reps[rep].timeRep * 1000u);
+            if (rep + 1 < current.reps.size()) {
+                add(RepState::POST, set, rep, current.reps[rep].timeRest * 1000u);
+            }
+        }
+        if (set + 1 < exercise.sets.size()) {
+            add(RepState::SET_PAUSE, set, current.reps.empty() ? 0 : current.reps.size() - 1,
+                static_cast<uint32_t>(current.timePauseAfter) * 1000u);
+        }
+    }
+    return phases;
+}
+
+const char* phaseName(RepState phase) {
+    switch (phase) {
+    case RepState::PRE:
+        return "PRE";
+    case RepState::IN_PROGRESS:
+        return "IN_PROGRESS";
+    case RepState::POST:
+        return "POST";
+    case RepState::SET_PAUSE:
+        return "SET_PAUSE";
+    }
+    return "?";
+}
+
+// Returns an empty string if the timeline matches, else the first difference
+std::string compareTimeline(const Exercise& exercise, const ExerciseTimeline& timeline, uint32_t durationMs) {
+    uint32_t totalMs = 0;
+    const std::vector<TimelinePhase> expected = expectedPhases(exercise, totalMs);
+    char text[160];
+    for (size_t i = 0; i < std::max(expected.size(), timeline.size()); ++i) {
+        if (i >= timeline.size() || i >= expected.size()) {
+            std::snprintf(text, sizeof(text), "%zu phases, expected %zu", timeline.size(), expected.size());
+            return text;
+        }
+        const TimelinePhase& got = timeline[i];
+        const TimelinePhase& want = expected[i];
+        if (got.phase != want.phase || got.setIndex != want.setIndex || got.repIndex != want.repIndex ||
+            got.startMs != want.startMs) {
+            std::snprintf(text, sizeof(text), "phase %zu is %s set %u rep %u at %u ms, expected %s set %u rep %u at %u ms",
+                          i, phaseName(got.phase), got.setIndex, got.repIndex, static_cast<unsigned>(got.startMs),
+                          phaseName(want.phase), want.setIndex, want.repIndex, static_cast<unsigned>(want.startMs));
+            return text;
+        }
+    }
+    // The rules themselves, independent of the expected list above
+    for (size_t i = 0; i < timeline.size(); ++i) {
+        const TimelinePhase& entry = timeline[i];
+        const Set& set = exercise.sets[entry.setIndex];
+        if (entry.phase == RepState::POST && entry.repIndex + 1u >= set.reps.size()) {
+            std::snprintf(text, sizeof(text), "rest after the last rep of set %u", entry.setIndex + 1u);
+            return text;
+        }
+        if (entry.phase == RepState::SET_PAUSE && entry.setIndex + 1u >= exercise.sets.size()) {
+            return "set pause after the last set";
+        }
+    }
+    if (timeline.totalMs() != totalMs || durationMs != totalMs) {
+        std::snprintf(text, sizeof(text), "total %u ms, durationMs() %u ms, expected %u ms",
+                      static_cast<unsigned>(timeline.totalMs()), static_cast<unsigned>(durationMs),
+                      static_cast<unsigned>(totalMs));
+        return text;
+    }
+    return std::string();
+}
+
+int runTimerTimeline() {
+    Exercise mixed("Mixed");
+    Set warmup("Warmup", 60, 50);
+    warmup.reps.emplace_back(10, 5);
+    warmup.reps.emplace_back(10, 5);
+    warmup.reps.emplace_back(7, 3); // a second rep group, with a rest of its own
+    mixed.sets.push_back(warmup);
+    Set main("Main", 0, 90); // no set pause before the last set
+    main.reps.emplace_back(7, 3);
+    main.reps.emplace_back(7, 0); // no rest between the last two reps
+    main.reps.emplace_back(5, 30);
+    mixed.sets.push_back(main);
+    Set last("Last", 240, 100); // its set pause must not be played
+    last.reps.emplace_back(10, 180);
+    mixed.sets.push_back(last);
+
+    Exercise largest("Largest");
+    for (size_t set = 0; set < limits::kMaxSets; ++set) {
+        Set full("Full", 120, 80);
+        for (size_t rep = 0; rep < limits::kMaxRepsPerSet; ++rep) {
+            full.reps.emplace_back(7, rep % 2 ? 3 : 5);
+        }
+        largest.sets.push_back(full);
+    }
+
+    const Scenario scenarios[] = {
+        {"single rep", makeExercise("Single", 1, 1, 10, 180, 300)},
+        {"one set, 6 reps", makeExercise("Repeaters", 1, 6, 7, 3, 120)},
+        {"3 sets x 6", makeExercise("Repeaters", 3, 6, 7, 3, 120)},
+        {"no rests", makeExercise("Short", 2, 30, 1, 0, 5)},
+        {"no set pauses", makeExercise("Chain", 4, 2, 5, 5, 0)},
+        {"mixed groups", mixed},
+        {"15 sets x 30", largest},
+    };
+    bool ok = true;
+    std::printf("%-16s %8s %12s  %s\n", "exercise", "phases", "total s", "result");
+    for (const Scenario& scenario : scenarios) {
+        StorageService::ExerciseId id;
+        if (!storageService.addExercise(scenario.exercise, &id)) {
+            std::printf("%-16s cannot be stored\n", scenario.name);
+            ok = false;
+            continue;
+        }
+        ExerciseTimeline timeline;
+        const StorageService::ExerciseRef stored = storageService.find(id);
+        timeline.build(stored.view());
+        const std::string difference =
+            compareTimeline(scenario.exercise, timeline, ExerciseTimeline::durationMs(stored.view()));
+        storageService.removeExercise(id);
+
+        // Played through the timer task, the session must last exactly as long
+        SessionResult result;
+        const bool played = runSession(
+            scenario.exercise, result, [] { return 0u; }, [](uint64_t) {});
+        const bool playedOnTime = played && result.sessionUs == static_cast<uint64_t>(timeline.totalMs()) * 1000ULL;
+
+        std::printf("%-16s %8zu %12.1f  %s%s\n", scenario.name, timeline.size(), timeline.totalMs() / 1000.0,
+                    difference.empty() ? "ok" : ("FAIL: " + difference).c_str(),
+                    playedOnTime ? "" : ", FAIL: played session differs");
+        ok = ok && difference.empty() && playedOnTime;
+    }
+    return ok ? 0 : 1;
+}
+
+void displayTask(void*) {
+    displayService.attachFlushTask();
+    for (;;) {
+        displayService.flushPending(DisplayService::kWaitForever);
+    }
+}
+
+struct JitterResult {
+    std::vector<uint64_t> phaseUs; // wakeup after a phase boundary, minus the boundary
+    std::vector<uint64_t> wakeUs;  // every wakeup minus the deadline of the step before it
+    uint32_t dropped = 0;
+};
+
+bool runJitterSession(const Exercise& exercise, JitterResult& result) {
+    StorageService::ExerciseId id;
+    uint64_t epochUs = 0;
+    uint32_t waitMs = startSession(exercise, id, &epochUs);
+    if (waitMs == TimerScheduler::kForever) {
+        return false;
+    }
+    ExerciseTimeline timeline;
+    timeline.build(storageService.find(id).view());
+    displayService.resetStats();
+
+    size_t phase = 0;
+    uint64_t stepUs = epochUs;
+    while (E == ExerciseState::STARTED && waitMs != TimerScheduler::kForever) {
+        const uint64_t dueUs = stepUs + static_cast<uint64_t>(waitMs) * 1000ULL;
+        timerScheduler.waitFor(waitMs);
+        stepUs = timerScheduler.nowUs();
+        result.wakeUs.push_back(stepUs > dueUs ? stepUs - dueUs : 0);
+        while (phase < timeline.size() && stepUs - epochUs >= static_cast<uint64_t>(timeline.phaseEndMs(phase)) * 1000ULL) {
+            result.phaseUs.push_back(stepUs - epochUs - static_cast<uint64_t>(timeline.phaseEndMs(phase)) * 1000ULL);
+            ++phase;
+        }
+        waitMs = timerStep();
+    }
+    // Dismiss "Fertig!" instead of waiting out its two seconds
+    commandBus.post(CommandType::DISMISS);
+    for (int step = 0; step < 3 && E != ExerciseState::IDLE; ++step) {
+        timerStep();
+    }
+    result.dropped = displayService.stats().framesDropped;
+    storageService.removeExercise(id);
+    return E == ExerciseState::IDLE && phase == timeline.size();
+}
+
+int runTimerJitter(uint32_t reps) {
+    timerScheduler.setClock(nullptr, realWait);
+    const Exercise exercise = makeExercise("Jitter", 1, static_cast<int>(reps), 1, 1, 0);
+    struct Config {
+        const char* name;
+        uint32_t i2cHz;
+        bool displayTask;
+    };
+    const Config configs[] = {
+        {"no bus", 0, false},
+        {"400 kHz, timer task", 400000, false},
+        {"100 kHz, timer task", 100000, false},
+        {"400 kHz, display task", 400000, true},
+        {"100 kHz, display task", 100000, true},
+    };
+    std::printf("%-22s %14s %26s %26s %8s\n", "flush", "transitions", "phase late p50/p99/max ms",
+                "wakeup late p50/p99/max ms", "dropped");
+    bool displayTaskRunning = false;
+    for (const Config& config : configs) {
+        if (config.displayTask && !displayTaskRunning) {
+            xTaskCreate(displayTask, "DisplayTask", 3072, nullptr, 1, nullptr);
+            displayTaskRunning = true;
+            delay(10);
+        }
+        nativeSetI2cClock(config.i2cHz);
+        JitterResult result;
+        if (!runJitterSession(exercise, result)) {
+            std::printf("%s: session did not finish\n", config.name);
+            return 1;
+        }
+        std::printf("%-22s %14zu %10.2f/%6.2f/%7.2f %10.2f/%6.2f/%7.2f %8u\n", config.name, result.phaseUs.size(),
+                    percentile(result.phaseUs, 0.5) / 1000.0, percentile(result.phaseUs, 0.99) / 1000.0,
+                    percentile(result.phaseUs, 1.0) / 1000.0, percentile(result.wakeUs, 0.5) / 1000.0,
+                    percentile(result.wakeUs, 0.99) / 1000.0, percentile(result.wakeUs, 1.0) / 1000.0,
+                    static_cast<unsigned>(result.dropped));
+    }
+    nativeSetI2cClock(0);
+    return 0;
+}
+
+} // namespace
+
+int runTimerTool(int argc, char** argv) {
+    nativeSetSerialMuted(true);
+    timerScheduler.setClock(simNow, simWait);
+    storageService.loadPersistent();
+    persistenceWorker.begin();
+    displayService.begin();
+    if (std::strcmp(argv[1], "--timer-wakeups") == 0) {
+        return runTimerWakeups();
+    }
+    if (std::strcmp(argv[1], "--timer-drift") == 0) {
+        const long sessions = argc >= 3 ? std::strtol(argv[2], nullptr, 10) : 1000;
+        return runTimerDrift(sessions > 0 ? static_cast<uint32_t>(sessions) : 1000);
+    }
+    if (std::strcmp(argv[1], "--timer-alloc") == 0) {
+        return runTimerAlloc();
+    }
+    if (std::strcmp(argv[1], "--timer-jitter") == 0) {
+        const long reps = argc >= 3 ? std::strtol(argv[2], nullptr, 10) : 5;
+        return runTimerJitter(reps > 0 && reps <= static_cast<long>(limits::kMaxRepsPerSet) ? static_cast<uint32_t>(reps) : 5);
+    }
+    if (std::strcmp(argv[1], "--timer-budget") == 0) {
+        const long budgetUs = argc >= 3 ? std::strtol(argv[2], nullptr, 10) : 5000;
+        return runTimerBudget(budgetUs > 0 ? static_cast<uint32_t>(budgetUs) : 5000);
+    }
+    if (std::strcmp(argv[1], "--timer-commands") == 0) {
+        const long seconds = argc >= 3 ? std::strtol(argv[2], nullptr, 10) : 3;
+        return runTimerCommands(seconds > 0 ? static_cast<uint32_t>(seconds) : 3);
+    }
+    if (std::strcmp(argv[1], "--timer-timeline") == 0) {
+        return runTimerTimeline();
+    }
+    std::fprintf(stderr,
+                 "usage: %s [--timer-wakeups | --timer-drift [sessions] | --timer-alloc | --timer-jitter [reps] |"
+                 " --timer-budget [us] | --timer-commands [seconds] | --timer-timeline]\n",
+                 argv[0]);
+    return 2;
+}
@@ -1,8 +1,11 @@
 #include "globals.h"
 
 BoardService boardService;
+CommandBus commandBus;
 DisplayService displayService;
+TimerScheduler timerScheduler;
 StorageService storageService;
+PersistenceWorker persistenceWorker(storageService);
 WebService webService;
 
 unsigned long timePrev = 0;
@@ -5,7 +5,10 @@
 #include <Arduino.h>
 #include "models/datastructures.h"
 #include "services/board/board.h"
+#include "services/commands/commandbus.h"
 #include "services/display/displayservice.h"
+#include "services/scheduler/timerscheduler.h"
+#include "services/storage/persistenceworker.h"
 #include "services/storage/storageservice.h"
 #include "services/web/webpage.h"
 
@@ -17,8 +20,11 @@
 
 
 extern BoardService boardService;
+extern CommandBus commandBus;
 extern DisplayService displayService;
+extern TimerScheduler timerScheduler;
 extern StorageService storageService;
+extern PersistenceWorker persistenceWorker;
 extern WebService webService;
 
 extern unsigned long timePrev;
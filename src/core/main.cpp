@@ -3,18 +3,27 @@
 #include <Wire.h>
 #include <WiFi.h>
 #include <WebServer.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include "models/datastructures.h"
+#include "models/timeline.h"
 #include "globals.h"
+#include "timebase.h"
 
 #define BUTTON_PIN 0 // GPIO-Pin für den Button (z. B. GPIO 0)
 
 // declaration of functions
 void printTimer(unsigned long timeMillis, String label = "");
 void resetRuntime();
-void resumeExercise(unsigned long now);
-void doExerciseStep(const Exercise& exercise, unsigned long now);
-static unsigned long elapsedMs(unsigned long now, unsigned long since);
-void pauseExercise(unsigned long now);
+void resumeExercise(uint64_t nowUs);
+uint32_t doExerciseStep(uint64_t nowUs);
+void finishExercise(uint64_t nowUs);
+static uint64_t sessionElapsedUs(uint64_t nowUs);
+void pauseExercise(uint64_t nowUs);
+void applyCommand(const Command& command);
+void startSelectedExercise();
+uint32_t timerStep();
 
 // Zugangsdaten für den Access Point
 const char* ssid = "ESP32_IntervalTimer";
@@ -23,81 +32,103 @@ const char* password = "12345678";
 // Webserver auf Port 80
 WebServer server(80);
 
-ExerciseState E = ExerciseState::IDLE;
-WifiState W = WifiState::INACTIVE;
+// Nur der Timer-Task schreibt E und W (über die CommandBus-Befehle); Button- und
+// Web-Task lesen sie lediglich.
+std::atomic<ExerciseState> E{ExerciseState::IDLE};
+std::atomic<WifiState> W{WifiState::INACTIVE};
 static ExerciseRuntime runtime;
+static ExerciseTimeline timeline; // beim Start einmal aus der gewählten Übung kompiliert
+
+// Dauer der vorübergehenden Bildschirme; sie laufen als Deadlines im Timer-Task ab
+constexpr uint32_t kFinishedScreenMs = 2000;
+constexpr uint32_t kSetSummaryMs = 2000;
 
 namespace {
-StorageService::ExerciseId g_selectedExerciseId{};
+// gehört dem Timer-Task, wird nur über Command::SELECT gesetzt; als Handle löst der
+// IDLE-Bildschirm die Auswahl bei jedem Durchlauf ohne Suche auf
+StorageService::ExerciseHandle g_selectedExercise{};
 bool g_hasSelectedExercise = false;
-
-void logSelectedExercise(const StorageService::ExerciseRecord& record) {
-    // Serial.printf("[Button] Selected exercise: %s (%u sets)\n",
-    //               record.exercise.name.c_str(),
-    //               static_cast<unsigned>(record.exercise.sets.size()));
-    for (size_t setIndex = 0; setIndex < record.exercise.sets.size(); ++setIndex) {
-        const Set& set = record.exercise.sets[setIndex];
-        // Serial.printf("  Set %u (%s): intensity=%d%%, reps=%u\n",
-        //               static_cast<unsigned>(setIndex + 1),
-        //               set.label.c_str(),
-        //               set.percentMaxIntensity,
-        //               static_cast<unsigned>(set.reps.size()));
-    }
-}
+// START wartet, bis der Persistenz-Task den Körper in den Cache geladen hat
+bool g_startPending = false;
+uint32_t g_startTicket = 0; // Auftrag an PersistenceWorker::preload(), 0 = keiner
 } // namespace
 
 void timerTask(void* parameter) {
+    timerScheduler.attach();
+    commandBus.attach();
     for (;;) {
-        
-        // Setzt numSets, timeRep, timeRest, timeStart und unterbrochen entsprechend der Eingaben
-        // Sowie die States STARTED, STOPPED, PAUSED, IDLE verwalten
-        
-        now = millis();
-
-        if (E == ExerciseState::STARTED) {
-            // exercise();
-            resumeExercise(now);
-            if (g_hasSelectedExercise) {
-                if (const Exercise* exercise = storageService.findExercise(g_selectedExerciseId)) {
-                    // Serial.printf("[TimerTask] Übung läuft: %s\n", exercise->name.c_str());
-                    // Hier die Logik zum Verarbeiten der Übung implementieren
-                    doExerciseStep(*exercise, now);
-                } else {
-                    // Serial.println("[TimerTask] Ausgewählte Übung nicht mehr verfügbar.");
-                    g_hasSelectedExercise = false;
-                    E = ExerciseState::IDLE;
-                    displayService.showStatus("Keine Übung", "Bitte auswählen");
-                }
-            } else {
-                // Serial.println("[TimerTask] Keine Übung ausgewählt.");
-                E = ExerciseState::IDLE;
-                displayService.showStatus("Bereit", "Button drücken");
-            }
-
-        } else if (E == ExerciseState::PAUSED) {
-            // Übung pausiert, nichts tun
-            pauseExercise(now);
-            // LOG_COLOR_D("TimerTask: PAUSED state - exercise is paused.\n");
-            displayService.setLine(1, "PAUSE", u8g2_font_ncenB24_tr, 48);
-            displayService.refresh();
-
-        } else if (E == ExerciseState::STOPPED) {
-            // Übung gestoppt, alles zurücksetzen
-            // displayTime(0);
-            // Reset aller Variablen und anzeige Stopped
-            resetRuntime();
+        timerScheduler.waitFor(timerStep());
+    }
+}
 
+// Ein Durchlauf des Timer-Tasks; liefert die Zeit in ms bis zum nächsten Aufwachen
+// (TimerScheduler::kForever, wenn nur ein Befehl weiterhilft).
+uint32_t timerStep() {
+    
+    // Setzt numSets, timeRep, timeRest, timeStart und unterbrochen entsprechend der Eingaben
+    // Sowie die States STARTED, STOPPED, PAUSED, IDLE verwalten
+    Command command;
+    while (commandBus.poll(command)) {
+        applyCommand(command);
+    }
+    if (g_startPending) {
+        startSelectedExercise();
+    }
+    
+    now = millis();
+    const uint64_t nowUs = timerScheduler.nowUs();
+    // Ohne laufenden Countdown schläft der Task, bis Button oder Web ihn wecken.
+    uint32_t waitMs = TimerScheduler::kForever;
+
+    if (E == ExerciseState::STARTED) {
+        // exercise();
+        resumeExercise(nowUs);
+        if (runtime.active && !timeline.empty()) {
+            waitMs = doExerciseStep(nowUs);
+        } else {
+            // Serial.println("[TimerTask] Keine Übung ausgewählt.");
             E = ExerciseState::IDLE;
-            // displayService.showStatus("Gestoppt", "Button: Start");
+            displayService.showStatus("Bereit", "Button drücken");
+            waitMs = 0;
+        }
+
+    } else if (E == ExerciseState::PAUSED) {
+        // Übung pausiert, nichts tun
+        pauseExercise(nowUs);
+        // LOG_COLOR_D("TimerTask: PAUSED state - exercise is paused.\n");
+        displayService.showPause();
 
-        } else if (E == ExerciseState::IDLE) {
-            // LOG_COLOR_D("TimerTask: IDLE state - waiting for start command.\n");
-            // Warte auf Startbefehl
-            timePrev = millis();
-            displayService.chooseExercise(storageService.findExercise(g_selectedExerciseId), W);
+    } else if (E == ExerciseState::FINISHED) {
+        // "Fertig!" bleibt bis zur Deadline stehen, Button-Befehle werden weiter angenommen
+        if (nowUs >= runtime.finishedUntilUs) {
+            E = ExerciseState::STOPPED;
+            waitMs = 0;
+        } else {
+            waitMs = static_cast<uint32_t>((runtime.finishedUntilUs - nowUs + 999ULL) / 1000ULL);
         }
-        vTaskDelay(25 / portTICK_PERIOD_MS);
+
+    } else if (E == ExerciseState::STOPPED) {
+        // Übung gestoppt, alles zurücksetzen
+        // displayTime(0);
+        // Reset aller Variablen und anzeige Stopped
+        resetRuntime();
+        // Nach einer Übung wird das Gerät gern ausgeschaltet: offene Web-Änderungen jetzt schreiben
+        // lassen, im Persistenz-Task statt auf dem kleinen Stack des Timer-Tasks
+        persistenceWorker.requestFlush();
+
+        E = ExerciseState::IDLE;
+        waitMs = 0;
+        // displayService.showStatus("Gestoppt", "Button: Start");
+
+    } else if (E == ExerciseState::IDLE) {
+        // LOG_COLOR_D("TimerTask: IDLE state - waiting for start command.\n");
+        // Warte auf Startbefehl
+        timePrev = millis();
+        // lock-freier Blick auf den aktuellen Stand, Änderungen aus dem Web stören ihn nicht
+        const StorageService::LibraryRef library = storageService.library();
+        displayService.chooseExercise(library->resolveSummary(g_selectedExercise), W);
     }
+    return waitMs;
 }
 // Webserver-Task
 void webServerTask(void* parameter) {
@@ -123,6 +154,8 @@ void webServerTask(void* parameter) {
             vTaskDelay(10 / portTICK_PERIOD_MS);
         } else {
             if (apActive) {
+                // ohne WLAN kommen keine Änderungen mehr, Ausstehendes nicht erst nach dem Fenster schreiben
+                persistenceWorker.flush();
                 server.stop();
                 WiFi.softAPdisconnect(true);
                 WiFi.mode(WIFI_OFF);
@@ -135,85 +168,89 @@ void webServerTask(void* parameter) {
     }
 }
 
+// Persistenz-Task: schreibt Änderungen aus dem Web gesammelt ins NVS (siehe PersistenceWorker)
+void persistenceTask(void* parameter) {
+    persistenceWorker.run();
+}
+
+// Display-Task: zeichnet und überträgt die vom Timer-Task zusammengesetzten Bilder,
+// damit der I2C-Transfer nicht im zeitkritischen Timer-Task läuft.
+void displayTask(void* parameter) {
+    displayService.attachFlushTask();
+    for (;;) {
+        displayService.flushPending(DisplayService::kWaitForever);
+    }
+}
+
 void loop() {
     // put your main code here, to run repeatedly:
 }
 
 void buttonTask(void* parameter) {
     static size_t currentExerciseIndex = 0;
+    boardService.begin();
     for (;;) {
 
-        const auto *buttons = boardService.getButtons();
+        const ButtonState button = boardService.getButtons();
+        if (button == ButtonState::NO_PRESS) {
+            // Schläft, bis die ISR eine Flanke meldet oder eine Entprell-Nachprüfung fällig ist
+            boardService.waitForEdges(boardService.idleTimeoutMs());
+            continue;
+        }
 
         // load first exercise from storage
-        
-        const auto& records = storageService.exercises();
+        // ein Stand für Anzahl und Id, auch wenn das Web gleichzeitig Übungen löscht
+        const StorageService::LibraryRef library = storageService.library();
+        const size_t exerciseCount = library->size();
 
         // bei short press:
-        switch(*buttons)
+        switch(button)
         {
         case ButtonState::SHORT_PRESS:
            if (E == ExerciseState::IDLE){
-                if (!records.empty()) {
-                    const size_t safeIndex = currentExerciseIndex % records.size();
-                    const auto& record = records[safeIndex];
-                    currentExerciseIndex = (safeIndex + 1) % records.size();
-                    g_selectedExerciseId = record.id;
-                    g_hasSelectedExercise = true;
-                    logSelectedExercise(record);
-                    // displayService.showStatus("Übung", record.exercise.name.c_str());
+                if (exerciseCount > 0) {
+                    const size_t safeIndex = currentExerciseIndex % exerciseCount;
+                    currentExerciseIndex = (safeIndex + 1) % exerciseCount;
+                    Command select;
+                    select.type = CommandType::SELECT;
+                    select.exerciseId = library->idAt(safeIndex);
+                    commandBus.post(select);
                 } else {
                     // Serial.println("[Button] Keine gespeicherten Übungen vorhanden.");
                     // displayService.showStatus("Keine Übungen", "Web anlegen");
                 }
            }
+           else if(E == ExerciseState::FINISHED){
+                // Abschlussbildschirm vorzeitig schließen
+                commandBus.post(CommandType::DISMISS);
+           }
            else if(E == ExerciseState::PAUSED){
                 // Serial.println("[Button] Setze Übung fort.");
-                E = ExerciseState::STARTED;
+                commandBus.post(CommandType::RESUME);
            } else if(E == ExerciseState::STARTED){
                 // Serial.println("[Button] Pausiere Übung.");
-                E = ExerciseState::PAUSED;
+                commandBus.post(CommandType::PAUSE);
            }
             break;
         // bei long press:
         case ButtonState::LONG_PRESS:
            if (E == ExerciseState::IDLE){
-                if (g_hasSelectedExercise) {
-                    if (const Exercise* exercise = storageService.findExercise(g_selectedExerciseId)) {
-                        // Serial.printf("[Button] Starte Übung: %s\n", exercise->name.c_str());
-                        // Hier muss die Übung Starten oder ein Flag gesetzt werden
-                        E = ExerciseState::STARTED;
-                        // Kann ich außerhalb auf den recied zugreifen?
-                        runtime.active = true;
-                        runtime.paused = false;
-                        runtime.phaseStart = millis();
-                        // displayService.showStatus("Start", exercise->name.c_str());
-                    } else {
-                        // Serial.println("[Button] Ausgewählte Übung nicht mehr verfügbar.");
-                        g_hasSelectedExercise = false;
-                        // displayService.showStatus("Übung fehlt", "Bitte wählen");
-                    }
-                }
+                commandBus.post(CommandType::START);
+           } else if (E == ExerciseState::FINISHED) {
+                commandBus.post(CommandType::DISMISS);
            } else {
-               if (const Exercise* exercise = storageService.findExercise(g_selectedExerciseId)){
-                //    Serial.printf("[Button] Stoppe Übung: %s\n", exercise->name.c_str());
-                    // displayService.showStatus("Gestoppt", exercise->name.c_str());
-                }
-                g_hasSelectedExercise = false;
-                E = ExerciseState::STOPPED;
+                commandBus.post(CommandType::STOP);
            }
             break;
         case ButtonState::EXTRA_LONG_PRESS:
             // currently not used
-            W = (W == WifiState::INACTIVE) ? WifiState::ACTIVE : WifiState::INACTIVE;
-            // Serial.printf("[Button] WiFi %s\n", W == WifiState::ACTIVE ? "aktiv" : "inaktiv");
+            commandBus.post(CommandType::TOGGLE_WIFI);
             break;
         case ButtonState::NO_PRESS:
         default:
             // Do nothing if no press
             break;
         }
-        vTaskDelay(50 / portTICK_PERIOD_MS);
     }
 }
 
@@ -230,6 +267,9 @@ void setup() {
         // Serial.println("[Setup] Konnte gespeicherte Übungen nicht laden.");
         // displayService.showStatus("Speicher", "Keine Daten");
     }
+    persistenceWorker.begin();
+    // Übungskörper lädt nur der Persistenz-Task; ein wartendes START geht danach im Timer-Task weiter
+    persistenceWorker.setPreloadListener([] { timerScheduler.notify(); });
 
     // Webserver-Task starten
     xTaskCreate(
@@ -241,13 +281,35 @@ void setup() {
         NULL             // Task-Handle
     );
 
-    // Timer-Task starten
+    // Persistenz-Task starten; braucht Stack für savePersistent() und den NVS-Zugriff
+    xTaskCreate(
+        persistenceTask,     // Funktion
+        "PersistenceTask",   // Name des Tasks
+        4096,                // Stack-Größe
+        NULL,                // Parameter
+        1,                   // Priorität
+        NULL                 // Task-Handle
+    );
+
+    // Display-Task starten
+    xTaskCreate(
+        displayTask,     // Funktion
+        "DisplayTask",   // Name des Tasks
+        3072,            // Stack-Größe
+        NULL,            // Parameter
+        1,               // Priorität
+        NULL             // Task-Handle
+    );
+
+    // Timer-Task starten, höher priorisiert als der Display-Task, damit ein laufender
+    // I2C-Transfer die Phasenwechsel nicht verzögert. Timer- und Button-Task lesen nie aus dem
+    // NVS (siehe startSelectedExercise()), dafür reichen 2048 Byte Stack.
     xTaskCreate(
         timerTask,       // Funktion
         "TimerTask",     // Name des Tasks
         2048,            // Stack-Größe
         NULL,            // Parameter
-        1,               // Priorität
+        2,               // Priorität
         NULL             // Task-Handle
     );
 
@@ -277,100 +339,162 @@ void printTimer(unsigned long timeMillis, String label)
     // displayService.showCountdown(headline, timeMillis);
 }
     
-void resumeExercise(unsigned long now) {
-    if (!runtime.active || !runtime.paused) return;
-    runtime.paused = false;
-    runtime.phaseStart = now - runtime.pauseOffset;
-    runtime.pauseOffset = 0;
-}
-
-void doExerciseStep(const Exercise& exercise, unsigned long now) {
-    if (!runtime.active || runtime.paused || runtime.setIndex >= exercise.sets.size()) {
-        return;
-    }
-
-    const Set& set = exercise.sets[runtime.setIndex];
-    const Rep& rep = set.reps[runtime.repIndex];
-    unsigned long elapsed = now - runtime.phaseStart;
-
-    switch (runtime.phase) {
-    case RepState::PRE:
-        if (elapsed >= 3000UL) {
-            runtime.phase = RepState::IN_PROGRESS;
-            runtime.phaseStart = now;
-        } else {
-            // display "Get Ready" with countdown
-            // printTimer(3000UL - elapsed, "Get Ready");
-            displayService.playTimer(&exercise, 3000UL - elapsed, runtime, W);
-            
+// Wendet einen Befehl aus dem CommandBus an; ungültige Befehle für den aktuellen Zustand
+// (z. B. PAUSE im IDLE) werden ignoriert.
+void applyCommand(const Command& command) {
+    switch (command.type) {
+    case CommandType::SELECT:
+        if (E == ExerciseState::IDLE) {
+            g_selectedExercise = storageService.library()->handleFor(command.exerciseId);
+            g_hasSelectedExercise = true;
+            g_startPending = false;
+            // lädt den Körper schon bei der Auswahl, START findet ihn dann im Cache
+            persistenceWorker.preload(command.exerciseId);
         }
         break;
-    case RepState::IN_PROGRESS:
-        if (elapsed >= rep.timeRep * 1000UL) {
-            runtime.phase = RepState::POST;
-            runtime.phaseStart = now;
-        } else {
-            // display "Exercise" with countdown and intensity
-            // printTimer(rep.timeRep * 1000UL - elapsed, "Exercise");
-            displayService.playTimer(&exercise, rep.timeRep * 1000UL - elapsed, runtime, W);
+    case CommandType::START:
+        if (E == ExerciseState::IDLE && g_hasSelectedExercise && !g_startPending) {
+            g_startPending = true;
+            g_startTicket = 0;
+            startSelectedExercise();
         }
         break;
-    case RepState::POST:
-
-        if(runtime.repIndex + 1 < set.reps.size()){
-            if (elapsed >= rep.timeRest * 1000UL) {
-                // zur nächsten Rep
-                runtime.repIndex++;
-                runtime.phase = RepState::IN_PROGRESS;
-                runtime.phaseStart = now;
-            } else {
-                // printTimer(rep.timeRest * 1000UL - elapsed, "Rest");
-                displayService.playTimer(&exercise, rep.timeRest * 1000UL - elapsed, runtime, W);
-                 // display "Rest" with countdown
-            }
-        } else {
-            // Set erledigt → Set-Pause einleiten
-            runtime.phase = RepState::SET_PAUSE;      // zusätzlicher Zustand
-            runtime.phaseStart = now;
-            // runtime.repIndex = 0;
+    case CommandType::PAUSE:
+        if (E == ExerciseState::STARTED) {
+            E = ExerciseState::PAUSED;
         }
-
         break;
-    case RepState::SET_PAUSE:
-        if (runtime.setIndex + 1 < exercise.sets.size()){
-            if (elapsed >= set.timePauseAfter * 1000UL) {
-                runtime.setIndex++;
-                runtime.repIndex = 0;
-                runtime.phase = RepState::PRE;
-                runtime.phaseStart = now;
-            }
-            else {
-                // printTimer(set.timePauseAfter * 1000UL - elapsed, "Set Pause");
-                displayService.playTimer(&exercise, set.timePauseAfter * 1000UL - elapsed, runtime, W);
-                // display "Set Pause" with countdown
-            }
-        } else {
-            // gesamte Übung fertig
-            runtime.active = false;
+    case CommandType::RESUME:
+        if (E == ExerciseState::PAUSED) {
+            E = ExerciseState::STARTED;
+        }
+        break;
+    case CommandType::STOP:
+        if (E == ExerciseState::STARTED || E == ExerciseState::PAUSED) {
+            g_hasSelectedExercise = false;
             E = ExerciseState::STOPPED;
-            // Serial.println("Exercise completed. Gut gemacht! :)");
-            displayService.showStatus("Fertig!", "Gut gemacht! :)");
-            delay(2000);
+        }
+        break;
+    case CommandType::DISMISS:
+        // wie der Timeout im FINISHED-Zweig: die Übung bleibt für den nächsten Start gewählt
+        if (E == ExerciseState::FINISHED) {
+            E = ExerciseState::STOPPED;
+        }
+        break;
+    case CommandType::TOGGLE_WIFI:
+        W = (W == WifiState::INACTIVE) ? WifiState::ACTIVE : WifiState::INACTIVE;
+        // Serial.printf("[Timer] WiFi %s\n", W == WifiState::ACTIVE ? "aktiv" : "inaktiv");
+        break;
+    }
+}
 
+// Startet die gewählte Übung, sobald ihr Körper im Cache liegt. Der Timer-Task liest nie selbst
+// aus dem NVS (kleiner Stack): bei einem Fehlzugriff lädt der Persistenz-Task nach und weckt ihn
+// danach über timerScheduler.notify(). Fehlt der Körper auch dann, gilt die Übung als nicht mehr verfügbar.
+void startSelectedExercise() {
+    const StorageService::ExerciseRef exercise = storageService.resolveCached(g_selectedExercise);
+    if (!exercise && storageService.library()->resolveSummary(g_selectedExercise)) {
+        if (g_startTicket == 0) {
+            g_startTicket = persistenceWorker.preload(g_selectedExercise.id);
+            return;
         }
+        if (!persistenceWorker.preloaded(g_startTicket)) {
+            return; // noch in Arbeit
+        }
+    }
+    g_startPending = false;
+    // Die Timeline liest Sets und Reps direkt aus dem gespeicherten Datensatz
+    if (timeline.build(exercise.view())) {
+        // Serial.printf("[Timer] Starte Übung: %.*s\n", static_cast<int>(exercise.name().size),
+        //               exercise.name().data);
+        runtime.active = true;
+        runtime.paused = false;
+        runtime.cursor = 0;
+        runtime.pausedUs = 0;
+        runtime.epochUs = timerScheduler.nowUs();
+        E = ExerciseState::STARTED;
+    } else {
+        // Serial.println("[Timer] Ausgewählte Übung nicht mehr verfügbar.");
+        g_hasSelectedExercise = false;
+    }
+}
 
-        break;
+void resumeExercise(uint64_t nowUs) {
+    if (!runtime.active || !runtime.paused) return;
+    runtime.paused = false;
+    runtime.pausedUs += nowUs - runtime.pauseStartUs;
+    runtime.pauseStartUs = 0;
+}
+
+// Schaltet die Timeline weiter, zeichnet das passende Bild und liefert die Zeit in ms bis
+// zur nächsten Deadline (Phasenende, Ende der Satz-Zusammenfassung oder nächstes Countdown-Bild).
+uint32_t doExerciseStep(uint64_t nowUs) {
+    if (!runtime.active || runtime.paused) {
+        return 0;
+    }
+
+    // Die Position ergibt sich immer aus dem idealen Ablauf seit epochUs; verspätetes
+    // Aufwachen verschiebt daher keine späteren Phasengrenzen.
+    const uint64_t elapsedUs = sessionElapsedUs(nowUs);
+    const uint64_t elapsedMs = elapsedUs / 1000ULL;
+    runtime.cursor = elapsedMs < timeline.totalMs()
+                         ? timeline.seek(static_cast<uint32_t>(elapsedMs), runtime.cursor)
+                         : timeline.size();
+
+    if (runtime.cursor >= timeline.size()) {
+        // gesamte Übung fertig; "Fertig!" steht bis zur Deadline, vorher gibt es nichts zu tun
+        finishExercise(nowUs);
+        return kFinishedScreenMs;
+    }
+
+    const TimelinePhase& entry = timeline[runtime.cursor];
+    runtime.setIndex = entry.setIndex;
+    runtime.repIndex = entry.repIndex;
+    runtime.phase = entry.phase;
+
+    // Countdown bis zum Ende der aktuellen Phase (Get Ready, Exercise, Rest, Set Pause),
+    // aufgerundet, damit die Deadline nicht vor der Phasengrenze liegt.
+    const uint64_t phaseEndUs = static_cast<uint64_t>(timeline.phaseEndMs(runtime.cursor)) * 1000ULL;
+    const uint32_t remaining = static_cast<uint32_t>((phaseEndUs - elapsedUs + 999ULL) / 1000ULL);
+
+    // Zu Beginn der Satzpause kurz eine Zusammenfassung statt des Countdowns. Die Dauer zählt in
+    // Übungszeit, eine Pause (Button) verlängert sie also mit.
+    const uint64_t phaseStartUs = static_cast<uint64_t>(entry.startMs) * 1000ULL;
+    if (entry.phase == RepState::SET_PAUSE && elapsedUs - phaseStartUs < kSetSummaryMs * 1000ULL) {
+        char done[24];
+        char next[24];
+        std::snprintf(done, sizeof(done), "Satz %u geschafft", static_cast<unsigned>(entry.setIndex + 1));
+        std::snprintf(next, sizeof(next), "Weiter mit Satz %u", static_cast<unsigned>(entry.setIndex + 2));
+        displayService.showStatus(done, next);
+        const uint64_t summaryEndUs = phaseStartUs + kSetSummaryMs * 1000ULL;
+        return std::min(remaining, static_cast<uint32_t>((summaryEndUs - elapsedUs + 999ULL) / 1000ULL));
     }
+
+    displayService.playTimer(remaining, runtime, timeline.percentMaxIntensity(entry.setIndex), W);
+    return TimerScheduler::nextDeadline(remaining, displayService.untilNextTimerFrame(runtime.phase, remaining));
 }
 
-static unsigned long elapsedMs(unsigned long now, unsigned long since) {
-    return now - since; // bei Bedarf auf millis()-Overflow anpassen
+// Zeigt "Fertig!" für kFinishedScreenMs, ohne den Timer-Task zu blockieren; das Ende
+// übernimmt der FINISHED-Zweig in timerTask.
+void finishExercise(uint64_t nowUs) {
+    runtime.active = false;
+    runtime.finishedUntilUs = nowUs + kFinishedScreenMs * 1000ULL;
+    E = ExerciseState::FINISHED;
+    // Serial.println("Exercise completed. Gut gemacht! :)");
+    displayService.showStatus("Fertig!", "Gut gemacht! :)");
 }
 
-void pauseExercise(unsigned long now) {
+// Vergangene Übungszeit ohne Pausen; während einer Pause steht sie still.
+static uint64_t sessionElapsedUs(uint64_t nowUs) {
+    const uint64_t reference = runtime.paused ? runtime.pauseStartUs : nowUs;
+    const uint64_t sinceEpoch = reference - runtime.epochUs;
+    return sinceEpoch > runtime.pausedUs ? sinceEpoch - runtime.pausedUs : 0;
+}
+
+void pauseExercise(uint64_t nowUs) {
     if (!runtime.active || runtime.paused) return;
     runtime.paused = true;
-    runtime.pauseOffset = elapsedMs(now, runtime.phaseStart);
+    runtime.pauseStartUs = nowUs;
 }
 
 
@@ -380,7 +504,10 @@ void resetRuntime() {
     runtime.setIndex = 0;
     runtime.repIndex = 0;
     runtime.phase = RepState::PRE;
-    runtime.phaseStart = 0;
-    runtime.pauseOffset = 0;
+    runtime.cursor = 0;
+    runtime.epochUs = 0;
+    runtime.pausedUs = 0;
+    runtime.pauseStartUs = 0;
+    runtime.finishedUntilUs = 0;
+    timeline.clear();
 }
-
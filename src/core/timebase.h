@@ -0,0 +1,24 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <cstdint>
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+// Monotone Zeit in Mikrosekunden seit Boot. 64 Bit laufen anders als millis() (49 Tage)
+// und micros() (71 Minuten) praktisch nie über.
+inline uint64_t monotonicMicros() {
+#ifdef ESP_PLATFORM
+    return static_cast<uint64_t>(esp_timer_get_time());
+#else
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return static_cast<uint64_t>(duration_cast<microseconds>(steady_clock::now() - start).count());
+#endif
+}
+
+#endif // TIMEBASE_H
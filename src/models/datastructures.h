@@ -1,11 +1,19 @@
 #ifndef DATASTRUCTURES_H
 #define DATASTRUCTURES_H
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <utility>
 
+#ifdef MODEL_FIXED_CAPACITY
+#include "utils/inlinestring.h"
+#include "utils/staticvector.h"
+#endif
+
 enum class ButtonState
 {
     NO_PRESS,
@@ -20,7 +28,7 @@ enum class WifiState
     INACTIVE,
 };
 
-enum class RepState
+enum class RepState : uint8_t
 {
     PRE,
     POST,
@@ -32,8 +40,11 @@ struct ExerciseRuntime {
     size_t setIndex = 0;
     size_t repIndex = 0;
     RepState phase = RepState::PRE;
-    unsigned long phaseStart = 0;
-    unsigned long pauseOffset = 0;
+    size_t cursor = 0;          // aktuelle Phase in der ExerciseTimeline
+    uint64_t epochUs = 0;       // Sitzungsbeginn, Phasengrenzen liegen bei epochUs + pausedUs + Offset
+    uint64_t pausedUs = 0;      // Summe aller bisherigen Pausen
+    uint64_t pauseStartUs = 0;  // Beginn der laufenden Pause
+    uint64_t finishedUntilUs = 0; // Ende des "Fertig!"-Bildschirms (ExerciseState::FINISHED)
     bool paused = false;
     bool active = false;
 };
@@ -44,32 +55,81 @@ enum class ExerciseState
     STOPPED,
     PAUSED,
     IDLE,
+    FINISHED,   // Abschlussbildschirm, endet per Deadline oder Button
 };
 
+// Grenzen einer Übung. Der StorageService prüft sie; mit MODEL_FIXED_CAPACITY sind Exercise und
+// Set genau danach bemessen und brauchen keinen Heap.
+namespace limits {
+constexpr size_t kMaxSets = 15;
+constexpr size_t kMaxRepsPerSet = 30;
+constexpr size_t kMaxExerciseNameLength = 64;
+constexpr size_t kMaxSetLabelLength = 64;
+constexpr int kMaxDurationS = UINT16_MAX; // Rep speichert Sekunden in 16 Bit
+} // namespace limits
+
 struct Rep {
-    int timeRep = 7;
-    int timeRest = 30;
+    uint16_t timeRep = 7;
+    uint16_t timeRest = 30;
+
+    // Werte außerhalb von 0 ... kMaxDurationS werden auf die Grenze gesetzt
+    Rep(int timeRep, int timeRest) : timeRep(clampDuration(timeRep)), timeRest(clampDuration(timeRest)) {}
 
-    Rep(int timeRep, int timeRest) : timeRep(timeRep), timeRest(timeRest) {}
+    static uint16_t clampDuration(int seconds) {
+        return static_cast<uint16_t>(std::max(0, std::min(seconds, limits::kMaxDurationS)));
+    }
 };
 
+#ifdef MODEL_FIXED_CAPACITY
+// Feste Kapazität: eine Übung ist immer gleich groß und liegt ganz im Objekt
+using ExerciseName = InlineString<limits::kMaxExerciseNameLength>;
+using SetLabel = InlineString<limits::kMaxSetLabelLength>;
+using RepList = StaticVector<Rep, limits::kMaxRepsPerSet>;
+#else
+using ExerciseName = std::string;
+using SetLabel = std::string;
+using RepList = std::vector<Rep>;
+#endif
+
 struct Set {
-    std::string label;      // Anzeigename des Sets
-    std::vector<Rep> reps;  // Dynamisches Array von Wiederholungen
+    SetLabel label;         // Anzeigename des Sets
+    RepList reps;           // Wiederholungen
     int timePauseAfter = 0;
     int percentMaxIntensity = 100;
 
     Set() = default;
-    Set(std::string label, int timePauseAfter, int percentMaxIntensity)
+    Set(SetLabel label, int timePauseAfter, int percentMaxIntensity)
         : label(std::move(label)), timePauseAfter(timePauseAfter), percentMaxIntensity(percentMaxIntensity) {}
 };
 
+#ifdef MODEL_FIXED_CAPACITY
+using SetList = StaticVector<Set, limits::kMaxSets>;
+#else
+using SetList = std::vector<Set>;
+#endif
+
 struct Exercise {
-    std::string name;             // Name der Übung
-    std::vector<Set> sets;        // Dynamisches Array von Sets
+    ExerciseName name;            // Name der Übung
+    SetList sets;                 // Sets der Übung
 
     Exercise() = default;
     explicit Exercise(const std::string& name) : name(name) {}
+
+    // true, wenn beim Befüllen ein Text gekürzt oder ein Set bzw. Rep verworfen wurde. Nur die
+    // Typen mit fester Kapazität kürzen; std::string und std::vector wachsen einfach mit.
+    bool truncated() const {
+#ifdef MODEL_FIXED_CAPACITY
+        if (name.truncated() || sets.overflowed()) {
+            return true;
+        }
+        for (const Set& set : sets) {
+            if (set.label.truncated() || set.reps.overflowed()) {
+                return true;
+            }
+        }
+#endif
+        return false;
+    }
 };
 
 #endif // DATASTRUCTURES_H
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "exerciseview.h"
+
+namespace varint {
+void append(std::vector<uint8_t>& buffer, uint32_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+bool read(const uint8_t* data, size_t length, size_t& offset, uint32_t& outValue) {
+    uint32_t value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (offset >= length) {
+            return false;
+        }
+        const uint8_t byte = data[offset++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            outValue = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+void appendText(std::vector<uint8_t>& buffer, const char* text, size_t size) {
+    append(buffer, static_cast<uint32_t>(size));
+    buffer.insert(buffer.end(), text, text + size);
+}
+
+bool readText(const uint8_t* data, size_t length, size_t& offset, TextView& out) {
+    uint32_t size = 0;
+    if (!read(data, length, offset, size) || size > length - offset) {
+        return false;
+    }
+    out.data = reinterpret_cast<const char*>(data + offset);
+    out.size = size;
+    offset += size;
+    return true;
+}
+} // namespace varint
+
+namespace {
+using varint::readText;
+
+// std::string oder InlineString, je nach MODEL_FIXED_CAPACITY
+template <typename Text>
+void appendText(std::vector<uint8_t>& buffer, const Text& text) {
+    varint::appendText(buffer, text.data(), text.size());
+}
+
+bool readGroup(const uint8_t* data, size_t length, size_t& offset, RepGroup& group) {
+    uint32_t repTime = 0;
+    uint32_t restTime = 0;
+    if (!varint::read(data, length, offset, group.count) || !varint::read(data, length, offset, repTime) ||
+        !varint::read(data, length, offset, restTime)) {
+        return false;
+    }
+    group.rep = Rep(static_cast<int>(repTime), static_cast<int>(restTime));
+    return true;
+}
+} // namespace
+
+bool SetView::parse(const uint8_t* data, size_t length, size_t& offset) {
+    uint32_t groups = 0;
+    if (!readText(data, length, offset, label_) || !varint::read(data, length, offset, pauseAfter_) ||
+        !varint::read(data, length, offset, percent_) || !varint::read(data, length, offset, groups)) {
+        return false;
+    }
+    groupsOffset_ = offset;
+    groupCount_ = 0;
+    repCount_ = 0;
+    for (uint32_t index = 0; index < groups; ++index) {
+        RepGroup group;
+        if (!readGroup(data, length, offset, group) || group.count > SIZE_MAX - repCount_) {
+            return false;
+        }
+        ++groupCount_;
+        repCount_ += group.count;
+    }
+    data_ = data;
+    length_ = length;
+    return true;
+}
+
+RepGroup SetView::group(size_t index) const {
+    RepGroup group;
+    if (index >= groupCount_) {
+        return RepGroup{};
+    }
+    size_t offset = groupsOffset_;
+    for (size_t i = 0; i <= index; ++i) {
+        readGroup(data_, length_, offset, group); // von parse() bereits geprüft
+    }
+    return group;
+}
+
+Rep SetView::rep(size_t index) const {
+    size_t offset = groupsOffset_;
+    for (size_t i = 0; i < groupCount_; ++i) {
+        RepGroup group;
+        readGroup(data_, length_, offset, group);
+        if (index < group.count) {
+            return group.rep;
+        }
+        index -= group.count;
+    }
+    return Rep(0, 0);
+}
+
+ExerciseView::ExerciseView(const uint8_t* data, size_t length) {
+    size_t offset = 0;
+    uint32_t sets = 0;
+    if (data == nullptr || !readText(data, length, offset, name_) || !varint::read(data, length, offset, sets)) {
+        name_ = TextView{};
+        return;
+    }
+    data_ = data;
+    length_ = length;
+    setsOffset_ = offset;
+    setCount_ = sets;
+}
+
+SetView ExerciseView::set(size_t index) const {
+    if (index >= setCount_) {
+        return SetView{};
+    }
+    size_t offset = setsOffset_;
+    SetView set;
+    for (size_t i = 0; i <= index; ++i) {
+        if (!set.parse(data_, length_, offset)) {
+            return SetView{};
+        }
+    }
+    return set;
+}
+
+Exercise ExerciseView::toExercise() const {
+    Exercise exercise;
+    exercise.name.assign(name_.data, name_.size);
+    exercise.sets.reserve(setCount_);
+    size_t offset = setsOffset_;
+    for (size_t index = 0; index < setCount_; ++index) {
+        SetView view;
+        if (!view.parse(data_, length_, offset)) {
+            break;
+        }
+        Set set;
+        set.label.assign(view.label_.data, view.label_.size);
+        set.timePauseAfter = view.timePauseAfter();
+        set.percentMaxIntensity = view.percentMaxIntensity();
+        set.reps.reserve(view.repCount());
+        // Gruppen am Stück durchlaufen; group(i) liest jedes Mal ab der ersten Gruppe
+        size_t groupOffset = view.groupsOffset_;
+        for (size_t group = 0; group < view.groupCount(); ++group) {
+            RepGroup entry;
+            readGroup(data_, length_, groupOffset, entry); // von parse() bereits geprüft
+            for (uint32_t rep = 0; rep < entry.count; ++rep) {
+                set.reps.push_back(entry.rep);
+            }
+        }
+        exercise.sets.push_back(std::move(set));
+    }
+    return exercise;
+}
+
+size_t ExerciseView::measure(const uint8_t* data, size_t length, size_t maxSets, size_t maxReps,
+                             size_t maxNameLength, size_t maxLabelLength) {
+    const ExerciseView view(data, length);
+    if (!view || view.name_.size > maxNameLength || view.setCount_ > maxSets) {
+        return 0;
+    }
+    size_t offset = view.setsOffset_;
+    for (size_t index = 0; index < view.setCount_; ++index) {
+        SetView set;
+        if (!set.parse(data, length, offset) || set.label_.size > maxLabelLength || set.groupCount_ > maxReps ||
+            set.repCount_ > maxReps) {
+            return 0;
+        }
+    }
+    return offset;
+}
+
+// Aufeinanderfolgende gleiche Reps werden als (Anzahl, Rep, Pause) abgelegt; aus dem
+// Webformular hat ein Set genau eine solche Gruppe.
+void ExerciseView::encode(std::vector<uint8_t>& buffer, const Exercise& exercise) {
+    appendText(buffer, exercise.name);
+    varint::append(buffer, static_cast<uint32_t>(exercise.sets.size()));
+    for (const auto& set : exercise.sets) {
+        appendText(buffer, set.label);
+        varint::append(buffer, static_cast<uint32_t>(set.timePauseAfter));
+        varint::append(buffer, static_cast<uint32_t>(set.percentMaxIntensity));
+
+        size_t groups = 0;
+        for (size_t i = 0; i < set.reps.size(); ++i) {
+            if (i == 0 || set.reps[i].timeRep != set.reps[i - 1].timeRep ||
+                set.reps[i].timeRest != set.reps[i - 1].timeRest) {
+                ++groups;
+            }
+        }
+        varint::append(buffer, static_cast<uint32_t>(groups));
+        for (size_t start = 0; start < set.reps.size();) {
+            size_t end = start + 1;
+            while (end < set.reps.size() && set.reps[end].timeRep == set.reps[start].timeRep &&
+                   set.reps[end].timeRest == set.reps[start].timeRest) {
+                ++end;
+            }
+            varint::append(buffer, static_cast<uint32_t>(end - start));
+            varint::append(buffer, static_cast<uint32_t>(set.reps[start].timeRep));
+            varint::append(buffer, static_cast<uint32_t>(set.reps[start].timeRest));
+            start = end;
+        }
+    }
+}
+
+ExerciseBuilder::ExerciseBuilder(const std::string& name, size_t capacity) {
+    buffer_.reserve(capacity);
+    appendText(buffer_, name);
+    setCountOffset_ = buffer_.size();
+    buffer_.push_back(0);
+}
+
+bool ExerciseBuilder::addSet(const std::string& label, int timePauseAfter, int percentMaxIntensity) {
+    if (buffer_[setCountOffset_] >= kMaxCount) {
+        return false;
+    }
+    ++buffer_[setCountOffset_];
+    appendText(buffer_, label);
+    varint::append(buffer_, static_cast<uint32_t>(timePauseAfter));
+    varint::append(buffer_, static_cast<uint32_t>(percentMaxIntensity));
+    groupCountOffset_ = buffer_.size();
+    buffer_.push_back(0);
+    lastGroupOffset_ = 0;
+    return true;
+}
+
+bool ExerciseBuilder::addReps(uint32_t count, const Rep& rep) {
+    if (groupCountOffset_ == 0) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    if (lastGroupOffset_ != 0 && rep.timeRep == lastRep_.timeRep && rep.timeRest == lastRep_.timeRest) {
+        if (count > kMaxCount - buffer_[lastGroupOffset_]) {
+            return false;
+        }
+        buffer_[lastGroupOffset_] = static_cast<uint8_t>(buffer_[lastGroupOffset_] + count);
+        return true;
+    }
+    if (count > kMaxCount || buffer_[groupCountOffset_] >= kMaxCount) {
+        return false;
+    }
+    ++buffer_[groupCountOffset_];
+    lastGroupOffset_ = buffer_.size();
+    buffer_.push_back(static_cast<uint8_t>(count));
+    varint::append(buffer_, static_cast<uint32_t>(rep.timeRep));
+    varint::append(buffer_, static_cast<uint32_t>(rep.timeRest));
+    lastRep_ = rep;
+    return true;
+}
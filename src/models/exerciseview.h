@@ -0,0 +1,150 @@
+#ifndef EXERCISEVIEW_H
+#define EXERCISEVIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "models/datastructures.h"
+
+// Text innerhalb eines Datensatzes, nicht nullterminiert
+struct TextView {
+    const char* data = "";
+    size_t size = 0;
+
+    bool empty() const { return size == 0; }
+};
+
+// LEB128: 7 Bit pro Byte, höchstes Bit = es folgt noch ein Byte. Werte < 128 brauchen ein Byte.
+// Texte stehen als Länge (Varint) gefolgt von den Bytes.
+namespace varint {
+constexpr size_t kMaxBytes = 5; // uint32_t
+
+constexpr size_t size(uint32_t value) { return value < 0x80 ? 1 : 1 + size(value >> 7); }
+
+void append(std::vector<uint8_t>& buffer, uint32_t value);
+bool read(const uint8_t* data, size_t length, size_t& offset, uint32_t& outValue);
+void appendText(std::vector<uint8_t>& buffer, const char* text, size_t size);
+bool readText(const uint8_t* data, size_t length, size_t& offset, TextView& out);
+} // namespace varint
+
+// Eckdaten einer Übung aus dem Index; Sets und Reps werden dafür nicht geladen.
+struct ExerciseSummary {
+    TextView name{};
+    uint32_t setCount = 0;
+    uint32_t durationS = 0;
+    bool valid = false;
+
+    explicit operator bool() const { return valid; }
+};
+
+// Aufeinanderfolgende gleiche Reps eines Sets
+struct RepGroup {
+    uint32_t count = 0;
+    Rep rep{0, 0};
+};
+
+// Ein Set innerhalb eines ExerciseView. Kopiert nichts; gültig, solange der Puffer des Views lebt.
+class SetView {
+public:
+    SetView() = default;
+
+    bool valid() const { return data_ != nullptr; }
+    TextView label() const { return label_; }
+    int timePauseAfter() const { return static_cast<int>(pauseAfter_); }
+    int percentMaxIntensity() const { return static_cast<int>(percent_); }
+    size_t groupCount() const { return groupCount_; }
+    size_t repCount() const { return repCount_; }
+    // Außerhalb des Bereichs: leere Gruppe bzw. Rep(0, 0)
+    RepGroup group(size_t index) const;
+    Rep rep(size_t index) const;
+
+private:
+    friend class ExerciseView;
+    // liest den Set-Kopf ab offset und setzt offset hinter die letzte Gruppe
+    bool parse(const uint8_t* data, size_t length, size_t& offset);
+
+    const uint8_t* data_ = nullptr;
+    size_t length_ = 0;
+    size_t groupsOffset_ = 0;
+    TextView label_{};
+    uint32_t pauseAfter_ = 0;
+    uint32_t percent_ = 0;
+    size_t groupCount_ = 0;
+    size_t repCount_ = 0;
+};
+
+// Liest eine Übung direkt aus ihrer gespeicherten Form (Storage-Format v2, ohne Id):
+//   Name, Anzahl Sets, je Set Label, Satzpause, Intensität, Gruppen (Anzahl, Rep, Pause).
+// Name, Sets und Reps werden erst beim Zugriff dekodiert; nichts davon landet auf dem Heap.
+// Ein View besitzt seinen Puffer nicht; aus dem StorageService gilt er, solange die ExerciseRef lebt.
+class ExerciseView {
+public:
+    ExerciseView() = default;
+    ExerciseView(const uint8_t* data, size_t length);
+
+    bool valid() const { return data_ != nullptr; }
+    explicit operator bool() const { return valid(); }
+
+    // Puffer, auf dem der View liegt
+    const uint8_t* data() const { return data_; }
+    size_t length() const { return length_; }
+
+    TextView name() const { return name_; }
+    size_t setCount() const { return setCount_; }
+    // Außerhalb des Bereichs: ungültiger SetView
+    SetView set(size_t index) const;
+
+    // Eigene Kopie, z. B. zum Bearbeiten
+    Exercise toExercise() const;
+
+    // Länge des Datensatzes am Anfang von data, 0 wenn er beschädigt ist oder die Grenzen verletzt
+    static size_t measure(const uint8_t* data, size_t length, size_t maxSets, size_t maxReps,
+                          size_t maxNameLength, size_t maxLabelLength);
+    static void encode(std::vector<uint8_t>& buffer, const Exercise& exercise);
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t length_ = 0;
+    size_t setsOffset_ = 0;
+    TextView name_{};
+    size_t setCount_ = 0;
+};
+
+// Baut eine Übung direkt in ihrer gespeicherten Form auf, ohne den Umweg über Exercise mit je
+// einem String und einem Vektor pro Set. Alles liegt in einem Block, der einmal mit der
+// angegebenen Kapazität (siehe capacity()) angelegt und am Ende als Ganzes freigegeben wird.
+// Anzahl Sets und Gruppen stehen als ein Byte vor ihren Einträgen und werden beim Anhängen
+// nachgetragen.
+class ExerciseBuilder {
+public:
+    static constexpr size_t kMaxCount = 0x7F; // passt als Varint in ein Byte
+
+    ExerciseBuilder(const std::string& name, size_t capacity);
+
+    // Blockgröße für höchstens sets Sets mit je groupsPerSet Gruppen innerhalb der Längengrenzen
+    static constexpr size_t capacity(size_t sets, size_t groupsPerSet, size_t maxNameLength,
+                                     size_t maxLabelLength) {
+        return varint::size(maxNameLength) + maxNameLength + 1 +
+               sets * (varint::size(maxLabelLength) + maxLabelLength + 2 * varint::kMaxBytes + 1 +
+                       groupsPerSet * (1 + 2 * varint::size(limits::kMaxDurationS)));
+    }
+
+    // false, wenn kMaxCount Sets erreicht sind
+    bool addSet(const std::string& label, int timePauseAfter, int percentMaxIntensity);
+    // Hängt count gleiche Reps an das letzte Set; gleichen sie der letzten Gruppe, wächst diese.
+    bool addReps(uint32_t count, const Rep& rep);
+
+    size_t setCount() const { return buffer_[setCountOffset_]; }
+    ExerciseView view() const { return ExerciseView(buffer_.data(), buffer_.size()); }
+
+private:
+    std::vector<uint8_t> buffer_;
+    size_t setCountOffset_ = 0;
+    size_t groupCountOffset_ = 0; // Anzahl Gruppen des letzten Sets, 0 = noch kein Set
+    size_t lastGroupOffset_ = 0;  // Anzahl Reps der letzten Gruppe, 0 = Set noch ohne Gruppe
+    Rep lastRep_{0, 0};
+};
+
+#endif // EXERCISEVIEW_H
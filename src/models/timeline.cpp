@@ -0,0 +1,143 @@
+#include "timeline.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+uint64_t secondsToMs(int seconds) {
+    return seconds > 0 ? static_cast<uint64_t>(seconds) * 1000ULL : 0;
+}
+} // namespace
+
+bool ExerciseTimeline::build(const ExerciseView& exercise) {
+    clear();
+    if (!exercise) {
+        return false;
+    }
+
+    // Anzahl der Phasen vorab bestimmen, damit das Array genau einmal alloziert wird.
+    const size_t setCount = exercise.setCount();
+    size_t phaseCount = 0;
+    for (size_t setIndex = 0; setIndex < setCount; ++setIndex) {
+        const size_t reps = exercise.set(setIndex).repCount();
+        phaseCount += 1 + reps + (reps > 0 ? reps - 1 : 0) + 1;
+    }
+    phases_.reserve(phaseCount);
+    setIntensity_.reserve(setCount);
+
+    for (size_t setIndex = 0; setIndex < setCount; ++setIndex) {
+        const SetView set = exercise.set(setIndex);
+        if (!set.valid()) {
+            clear();
+            return false;
+        }
+        setIntensity_.push_back(set.percentMaxIntensity());
+
+        if (!append(RepState::PRE, setIndex, 0, kPreparationMs)) {
+            clear();
+            return false;
+        }
+        // Reps liegen gruppiert vor; jede Gruppe wird in ihre einzelnen Reps aufgefaltet.
+        const size_t repCount = set.repCount();
+        size_t repIndex = 0;
+        for (size_t groupIndex = 0; groupIndex < set.groupCount(); ++groupIndex) {
+            const RepGroup group = set.group(groupIndex);
+            for (uint32_t n = 0; n < group.count; ++n, ++repIndex) {
+                bool ok = append(RepState::IN_PROGRESS, setIndex, repIndex, secondsToMs(group.rep.timeRep));
+                // Nach der letzten Rep eines Sets folgt direkt die Satzpause.
+                if (ok && repIndex + 1 < repCount) {
+                    ok = append(RepState::POST, setIndex, repIndex, secondsToMs(group.rep.timeRest));
+                }
+                if (!ok) {
+                    clear();
+                    return false;
+                }
+            }
+        }
+        // Nach dem letzten Set ist die Übung fertig, es gibt keine Satzpause mehr.
+        if (setIndex + 1 < setCount) {
+            const size_t lastRep = repCount == 0 ? 0 : repCount - 1;
+            if (!append(RepState::SET_PAUSE, setIndex, lastRep, secondsToMs(set.timePauseAfter()))) {
+                clear();
+                return false;
+            }
+        }
+    }
+    return !phases_.empty();
+}
+
+uint32_t ExerciseTimeline::durationMs(const ExerciseView& exercise) {
+    uint64_t total = 0;
+    const size_t setCount = exercise.setCount();
+    for (size_t setIndex = 0; setIndex < setCount; ++setIndex) {
+        const SetView set = exercise.set(setIndex);
+        total += kPreparationMs;
+        RepGroup group;
+        for (size_t groupIndex = 0; groupIndex < set.groupCount(); ++groupIndex) {
+            group = set.group(groupIndex);
+            total += group.count * (secondsToMs(group.rep.timeRep) + secondsToMs(group.rep.timeRest));
+        }
+        // nach der letzten Rep keine Pause, sondern Satzpause bzw. Ende
+        if (group.count > 0) {
+            total -= secondsToMs(group.rep.timeRest);
+        }
+        if (setIndex + 1 < setCount) {
+            total += secondsToMs(set.timePauseAfter());
+        }
+    }
+    return static_cast<uint32_t>(std::min<uint64_t>(total, std::numeric_limits<uint32_t>::max()));
+}
+
+void ExerciseTimeline::clear() {
+    phases_.clear();
+    setIntensity_.clear();
+    totalMs_ = 0;
+}
+
+bool ExerciseTimeline::append(RepState phase, size_t setIndex, size_t repIndex, uint64_t durationMs) {
+    if (durationMs == 0) {
+        // Phasen ohne Dauer würden beim Abspielen ohnehin sofort übersprungen.
+        return true;
+    }
+    if (totalMs_ + durationMs > std::numeric_limits<uint32_t>::max() || phases_.size() == phases_.max_size()) {
+        return false;
+    }
+    TimelinePhase entry;
+    entry.startMs = totalMs_;
+    entry.phase = phase;
+    entry.setIndex = static_cast<uint8_t>(setIndex);
+    entry.repIndex = static_cast<uint8_t>(repIndex);
+    phases_.push_back(entry);
+    totalMs_ += static_cast<uint32_t>(durationMs);
+    return true;
+}
+
+uint32_t ExerciseTimeline::phaseEndMs(size_t index) const {
+    return index + 1 < phases_.size() ? phases_[index + 1].startMs : totalMs_;
+}
+
+uint32_t ExerciseTimeline::remainingMs(uint32_t elapsedMs) const {
+    return elapsedMs < totalMs_ ? totalMs_ - elapsedMs : 0;
+}
+
+int ExerciseTimeline::percentMaxIntensity(size_t setIndex) const {
+    return setIndex < setIntensity_.size() ? setIntensity_[setIndex] : 0;
+}
+
+size_t ExerciseTimeline::seek(uint32_t elapsedMs, size_t hint) const {
+    if (elapsedMs >= totalMs_) {
+        return phases_.size();
+    }
+    // Schneller Pfad: gleiche Phase wie beim letzten Aufruf oder die direkt folgende.
+    if (hint < phases_.size() && phases_[hint].startMs <= elapsedMs) {
+        if (elapsedMs < phaseEndMs(hint)) {
+            return hint;
+        }
+        if (hint + 1 < phases_.size() && elapsedMs < phaseEndMs(hint + 1)) {
+            return hint + 1;
+        }
+    }
+    auto it = std::upper_bound(phases_.begin(), phases_.end(), elapsedMs,
+                               [](uint32_t value, const TimelinePhase& entry) { return value < entry.startMs; });
+    return static_cast<size_t>(std::distance(phases_.begin(), it)) - 1;
+}
@@ -0,0 +1,59 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "models/datastructures.h"
+#include "models/exerciseview.h"
+
+// Ein Eintrag der kompilierten Timeline; das Ende ergibt sich aus dem Start des Nachfolgers.
+struct TimelinePhase {
+    uint32_t startMs = 0;     // kumulierter Offset ab Übungsstart
+    RepState phase = RepState::PRE;
+    uint8_t setIndex = 0;
+    uint8_t repIndex = 0;
+};
+
+// Flache, einmal beim Start berechnete Abfolge aller Phasen (PRE, IN_PROGRESS, POST, SET_PAUSE)
+// einer Übung. Das Weiterschalten ist damit nur noch eine Suche über die vergangene Zeit.
+class ExerciseTimeline {
+public:
+    static constexpr uint32_t kPreparationMs = 3000;
+    // Je Set Vorbereitung, Reps, Pausen dazwischen und Satzpause
+    static constexpr size_t kMaxPhases = limits::kMaxSets * (2 * limits::kMaxRepsPerSet + 1);
+
+    bool build(const ExerciseView& exercise);
+    // Gesamtdauer wie totalMs() nach build(), ohne die Phasen anzulegen
+    static uint32_t durationMs(const ExerciseView& exercise);
+    void clear();
+
+    bool empty() const { return phases_.empty(); }
+    size_t size() const { return phases_.size(); }
+    const TimelinePhase& operator[](size_t index) const { return phases_[index]; }
+
+    uint32_t totalMs() const { return totalMs_; }
+    uint32_t phaseEndMs(size_t index) const;
+    uint32_t remainingMs(uint32_t elapsedMs) const;
+    int percentMaxIntensity(size_t setIndex) const;
+
+    // Index der Phase, die bei elapsedMs aktiv ist, oder size() wenn die Übung vorbei ist.
+    // hint ist der zuletzt gefundene Index; im Normalfall genügt ein Vergleich.
+    size_t seek(uint32_t elapsedMs, size_t hint = 0) const;
+
+private:
+    bool append(RepState phase, size_t setIndex, size_t repIndex, uint64_t durationMs);
+
+#ifdef MODEL_FIXED_CAPACITY
+    // für die größte erlaubte Übung bemessen, ein Start alloziert nichts
+    StaticVector<TimelinePhase, kMaxPhases> phases_;
+    StaticVector<int, limits::kMaxSets> setIntensity_;
+#else
+    std::vector<TimelinePhase> phases_;
+    std::vector<int> setIntensity_;
+#endif
+    uint32_t totalMs_ = 0;
+};
+
+#endif // TIMELINE_H
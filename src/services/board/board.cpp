@@ -1,59 +1,117 @@
 #include "board.h"
 
+BoardService* BoardService::instance_ = nullptr;
+
+namespace {
+const char* buttonStateName(ButtonState state)
+{
+    switch (state)
+    {
+    case ButtonState::EXTRA_LONG_PRESS:
+        return "EXTRA_LONG_PRESS";
+    case ButtonState::LONG_PRESS:
+        return "LONG_PRESS";
+    case ButtonState::SHORT_PRESS:
+        return "SHORT_PRESS";
+    case ButtonState::NO_PRESS:
+    default:
+        return "NO_PRESS";
+    }
+}
+} // namespace
+
 BoardService::BoardService()
-    : buttonState_(ButtonState::NO_PRESS)
+    : classifier_(LONG_PRESS_THRESHOLD_MS, EXTENDED_PRESS_THRESHOLD_MS)
 {
     SW1_PIN = kButtonPin;
     pinMode(kButtonPin, INPUT_PULLUP); // enable internal pull-up for button on D10
 }
 
 /*!
- *  @brief - sets hardware consts like pins/pinouts, resistors, etc. depending on the electronics version and sensor type
- *  @brief - also turns on the measuring current
+ *  @brief - registers the calling task as consumer of button edges
+ *  @brief - attaches the GPIO edge interrupt on the button pin
  */
+void BoardService::begin()
+{
+    consumer_ = xTaskGetCurrentTaskHandle();
+    instance_ = this;
+    attachInterrupt(digitalPinToInterrupt(SW1_PIN), &BoardService::onButtonEdge, CHANGE);
+}
 
+/*!
+ *  @brief - ISR: timestamps the edge, queues it and wakes the button task
+ */
+void IRAM_ATTR BoardService::onButtonEdge()
+{
+    BoardService* self = instance_;
+    if (!self)
+    {
+        return;
+    }
 
-const ButtonState *BoardService::getButtons()
+    ButtonEdge edge;
+    edge.timeMs = static_cast<uint32_t>(millis());
+    edge.level = static_cast<uint8_t>(digitalRead(self->SW1_PIN));
+    if (!self->edges_.push(edge))
+    {
+        self->droppedEdges_ = self->droppedEdges_ + 1;
+        self->edgesLost_ = true;
+    }
+
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    if (self->consumer_)
+    {
+        vTaskNotifyGiveFromISR(self->consumer_, &higherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+bool BoardService::waitForEdges(uint32_t timeoutMs)
 {
-    unsigned long curMil = millis();
+    const TickType_t ticks = timeoutMs == kWaitForever ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    return ulTaskNotifyTake(pdTRUE, ticks) > 0;
+}
 
-    if (sw1EventPending_)
+uint32_t BoardService::idleTimeoutMs() const
+{
+    if (!classifier_.resyncPending() && !edgesLost_)
     {
-        sw1EventPending_ = false;
-        buttonState_ = ButtonState::NO_PRESS;
+        return kWaitForever;
     }
+    const uint32_t curMil = static_cast<uint32_t>(millis());
+    const uint32_t due = classifier_.resyncAtMs();
+    return static_cast<int32_t>(due - curMil) > 0 ? due - curMil : 0;
+}
 
-    if (digitalRead(SW1_PIN) == LOW)
+ButtonState BoardService::getButtons()
+{
+    ButtonEdge edge;
+    while (edges_.pop(edge))
     {
-        if (!sw1Pressed_)
+        const ButtonState state = classifier_.feed(edge);
+        if (state != ButtonState::NO_PRESS)
         {
-            sw1Pressed_ = true;
-            pressStartSW1_ = curMil;
+            Serial.printf("BoardService - getButtons %s detected\n", buttonStateName(state));
+            return state;
         }
-        return &buttonState_;
     }
 
-    if (sw1Pressed_)
+    // Nach verworfenen Preller-Flanken oder übergelaufener Queue den tatsächlichen Pegel
+    // nach Ablauf der Sperrzeit übernehmen.
+    if (classifier_.resyncPending() || edgesLost_)
     {
-        sw1Pressed_ = false;
-        unsigned long pressDuration = curMil - pressStartSW1_;
-        if (pressDuration >= EXTENDED_PRESS_THRESHOLD_MS)
-        {
-            buttonState_ = ButtonState::EXTRA_LONG_PRESS;
-            Serial.println("BoardService - getButtons EXTRA_LONG_PRESS detected");
-        }
-        else if (pressDuration >= LONG_PRESS_THRESHOLD_MS)
+        const uint32_t curMil = static_cast<uint32_t>(millis());
+        if (static_cast<int32_t>(curMil - classifier_.resyncAtMs()) >= 0)
         {
-            buttonState_ = ButtonState::LONG_PRESS;
-            Serial.println("BoardService - getButtons LONG_PRESS detected");
+            edgesLost_ = false;
+            const ButtonState state = classifier_.resync(curMil, static_cast<uint8_t>(digitalRead(SW1_PIN)));
+            if (state != ButtonState::NO_PRESS)
+            {
+                Serial.printf("BoardService - getButtons %s detected\n", buttonStateName(state));
+                return state;
+            }
         }
-        else
-        {
-            buttonState_ = ButtonState::SHORT_PRESS;
-            Serial.println("BoardService - getButtons SHORT_PRESS detected");
-        }
-        sw1EventPending_ = true;
     }
 
-    return &buttonState_;
-}
\ No newline at end of file
+    return ButtonState::NO_PRESS;
+}
@@ -6,18 +6,30 @@
 #include <array>
 // models
 #include "models/datastructures.h"
+#include "services/board/buttonclassifier.h"
+#include "utils/spscqueue.h"
 
 class BoardService
 {
 public:
+    static constexpr uint32_t kWaitForever = UINT32_MAX;
+    // Schwellen der Druckdauer, auch für die synthetischen Flanken in --button-edges
+    static constexpr int LONG_PRESS_THRESHOLD_MS = 1000;
+    static constexpr int EXTENDED_PRESS_THRESHOLD_MS = 3000;
+
     BoardService();
 
-    const ButtonState *getButtons(); // TODO: consider returntype to be const reference
+    void begin();                    // aus dem Button-Task aufrufen: ISR anhängen, Task als Empfänger merken
+    ButtonState getButtons();        // nächster klassifizierter Druck oder NO_PRESS
+    bool waitForEdges(uint32_t timeoutMs); // schläft bis zur nächsten Flanke oder timeoutMs
+    uint32_t idleTimeoutMs() const;  // kWaitForever, außer eine Entprell-Nachprüfung steht aus
 
+    uint32_t droppedEdges() const { return droppedEdges_; }
 
 private:
+    static void IRAM_ATTR onButtonEdge();
 
-    ButtonState buttonState_;
+    static BoardService* instance_;
     
     // pin assignment, defined in board.cpp
     static constexpr int kButtonPin = 2; // D0 on XIAO ESP32C3 = GPIO1
@@ -25,12 +37,13 @@ private:
     int SW2_PIN = -1;        // Pin connected to Switch1
     
     // Buttons
-    static constexpr int LONG_PRESS_THRESHOLD_MS = 1000;
-    static constexpr int EXTENDED_PRESS_THRESHOLD_MS = 3000;
-    bool sw1Pressed_ = false;
-    bool sw1EventPending_ = false;
-    unsigned long pressStartSW1_ = 0;
-    int pressStartSW2_ = 0;
+    static constexpr size_t kEdgeQueueSize = 16;
+
+    SpscQueue<ButtonEdge, kEdgeQueueSize> edges_;   // ISR -> Button-Task
+    ButtonClassifier classifier_;
+    TaskHandle_t consumer_ = nullptr;
+    volatile uint32_t droppedEdges_ = 0;
+    volatile bool edgesLost_ = false;     // Queue übergelaufen, Pegel muss nachgelesen werden
 
 };
 
@@ -0,0 +1,56 @@
+#include "buttonclassifier.h"
+
+namespace {
+constexpr uint8_t kPressedLevel = 0; // LOW, Button zieht gegen GND
+} // namespace
+
+ButtonClassifier::ButtonClassifier(uint32_t longPressMs, uint32_t extendedPressMs, uint32_t debounceMs,
+                                   uint32_t minPressMs)
+    : longPressMs_(longPressMs), extendedPressMs_(extendedPressMs), debounceMs_(debounceMs), minPressMs_(minPressMs)
+{
+}
+
+ButtonState ButtonClassifier::feed(const ButtonEdge& edge) {
+    const bool pressed = edge.level == kPressedLevel;
+    if (pressed == pressed_) {
+        // Kein Zustandswechsel, z. B. zweite Flanke eines Prellers
+        return ButtonState::NO_PRESS;
+    }
+    if (hasAccepted_ && edge.timeMs - lastAcceptedMs_ < debounceMs_) {
+        // Prellen: innerhalb der Sperrzeit nach der letzten gültigen Flanke
+        resyncPending_ = true;
+        return ButtonState::NO_PRESS;
+    }
+
+    hasAccepted_ = true;
+    resyncPending_ = false;
+    lastAcceptedMs_ = edge.timeMs;
+    pressed_ = pressed;
+
+    if (pressed) {
+        pressStartMs_ = edge.timeMs;
+        return ButtonState::NO_PRESS;
+    }
+    return classify(edge.timeMs - pressStartMs_);
+}
+
+ButtonState ButtonClassifier::resync(uint32_t nowMs, uint8_t level) {
+    resyncPending_ = false;
+    ButtonEdge edge;
+    edge.timeMs = nowMs;
+    edge.level = level;
+    return feed(edge);
+}
+
+ButtonState ButtonClassifier::classify(uint32_t durationMs) const {
+    if (durationMs < minPressMs_) {
+        return ButtonState::NO_PRESS; // Störimpuls, kein echter Druck
+    }
+    if (durationMs >= extendedPressMs_) {
+        return ButtonState::EXTRA_LONG_PRESS;
+    }
+    if (durationMs >= longPressMs_) {
+        return ButtonState::LONG_PRESS;
+    }
+    return ButtonState::SHORT_PRESS;
+}
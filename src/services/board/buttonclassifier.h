@@ -0,0 +1,52 @@
+#ifndef BUTTONCLASSIFIER_H
+#define BUTTONCLASSIFIER_H
+
+#include <cstdint>
+// models
+#include "models/datastructures.h"
+
+// Zeitgestempelte Flanke am Button-Pin, wie sie die ISR in die Queue schreibt.
+struct ButtonEdge {
+    uint32_t timeMs = 0;
+    uint8_t level = 1; // HIGH = losgelassen (Pull-up), LOW = gedrückt
+};
+
+// Entprellt Flanken und ordnet vollständige Drücke SHORT/LONG/EXTRA_LONG zu; zu kurze verwirft sie.
+// Reine Logik ohne Hardwarezugriff, damit sie sich mit synthetischen Flanken prüfen lässt.
+class ButtonClassifier {
+public:
+    static constexpr uint32_t kDebounceMs = 20;
+    // Kürzere Drücke gelten als Störung. Muss über kDebounceMs liegen: ein einzelner EMV-Puls
+    // wird sofort als Druck angenommen und erst beim Resync nach der Sperrzeit wieder losgelassen.
+    static constexpr uint32_t kMinPressMs = 50;
+
+    ButtonClassifier(uint32_t longPressMs, uint32_t extendedPressMs, uint32_t debounceMs = kDebounceMs,
+                     uint32_t minPressMs = kMinPressMs);
+
+    // Liefert das Ergebnis eines abgeschlossenen Drucks, sonst NO_PRESS.
+    ButtonState feed(const ButtonEdge& edge);
+
+    // Nach verworfenen Flanken muss der Pegel nach Ablauf der Sperrzeit erneut gelesen werden,
+    // sonst könnte ein kurzer Druck innerhalb der Sperrzeit verloren gehen.
+    bool resyncPending() const { return resyncPending_; }
+    uint32_t resyncAtMs() const { return lastAcceptedMs_ + debounceMs_; }
+    ButtonState resync(uint32_t nowMs, uint8_t level);
+
+    bool pressed() const { return pressed_; }
+
+private:
+    ButtonState classify(uint32_t durationMs) const;
+
+    uint32_t longPressMs_;
+    uint32_t extendedPressMs_;
+    uint32_t debounceMs_;
+    uint32_t minPressMs_;
+
+    bool pressed_ = false;
+    bool hasAccepted_ = false;
+    bool resyncPending_ = false;
+    uint32_t lastAcceptedMs_ = 0;
+    uint32_t pressStartMs_ = 0;
+};
+
+#endif // BUTTONCLASSIFIER_H
@@ -0,0 +1,42 @@
+#include "commandbus.h"
+
+#include "core/timebase.h"
+
+void CommandBus::attach() {
+    consumer_.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+}
+
+bool CommandBus::post(CommandType type) {
+    Command command;
+    command.type = type;
+    return post(command);
+}
+
+bool CommandBus::post(const Command& command) {
+    Command stamped = command;
+    stamped.postedUs = monotonicMicros();
+    if (!queue_.push(stamped)) {
+        // Kein Serial-Log hier: post() läuft auch im Button-Task, verworfene Befehle zählt dropped()
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    posted_.fetch_add(1, std::memory_order_relaxed);
+
+    if (TaskHandle_t consumer = consumer_.load(std::memory_order_acquire)) {
+        xTaskNotifyGive(consumer);
+    }
+    return true;
+}
+
+bool CommandBus::poll(Command& out) {
+    if (!queue_.pop(out)) {
+        return false;
+    }
+    const uint64_t latency = monotonicMicros() - out.postedUs;
+    const uint32_t latencyUs = latency > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(latency);
+    lastLatencyUs_.store(latencyUs, std::memory_order_relaxed);
+    if (latencyUs > maxLatencyUs_.load(std::memory_order_relaxed)) {
+        maxLatencyUs_.store(latencyUs, std::memory_order_relaxed);
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstdint>
+
+#include "services/storage/storageservice.h"
+#include "utils/mpscqueue.h"
+
+enum class CommandType : uint8_t
+{
+    SELECT,
+    START,
+    PAUSE,
+    RESUME,
+    STOP,
+    TOGGLE_WIFI,
+    DISMISS, // "Fertig!" vorzeitig schließen, die Auswahl bleibt wie nach dem Timeout erhalten
+};
+
+struct Command {
+    CommandType type = CommandType::STOP;
+    StorageService::ExerciseId exerciseId{}; // nur für SELECT
+    uint64_t postedUs = 0;                   // Zeitstempel für die Latenzstatistik
+};
+
+// Befehle von Button- und Web-Task an die Timer-Zustandsmaschine. Der Timer-Task ist der
+// einzige Konsument und wird bei jedem post() direkt per Task-Notification geweckt.
+class CommandBus {
+public:
+    static constexpr size_t kQueueSize = 16;
+
+    void attach();                      // aus dem konsumierenden Task aufrufen
+    bool post(CommandType type);
+    bool post(const Command& command);
+    bool poll(Command& out);            // nur vom Konsumenten
+
+    uint32_t posted() const { return posted_.load(std::memory_order_relaxed); }
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint32_t lastLatencyUs() const { return lastLatencyUs_.load(std::memory_order_relaxed); }
+    uint32_t maxLatencyUs() const { return maxLatencyUs_.load(std::memory_order_relaxed); }
+
+private:
+    MpscQueue<Command, kQueueSize> queue_;
+    std::atomic<TaskHandle_t> consumer_{nullptr};
+    std::atomic<uint32_t> posted_{0};
+    std::atomic<uint32_t> dropped_{0};
+    std::atomic<uint32_t> lastLatencyUs_{0}; // nur der Konsument schreibt, gelesen wird von überall
+    std::atomic<uint32_t> maxLatencyUs_{0};
+};
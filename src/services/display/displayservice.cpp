@@ -4,7 +4,54 @@
 #include <Wire.h>
 #include <algorithm>
 #include <array>
+#include <cstdarg>
 #include <cstdio>
+#include <cstring>
+
+namespace {
+
+struct LineSlot {
+    uint8_t baseline;
+    const uint8_t* font;
+    TextAlign align;
+    int8_t offset;
+};
+
+constexpr uint8_t kLayoutSlots = 8;
+
+struct LayoutSpec {
+    uint8_t lineCount;
+    LineSlot slots[kLayoutSlots];
+};
+
+// Ein Eintrag je ScreenLayout (Reihenfolge wie im enum). Statt Leerzeichen aufzufüllen hat jedes
+// Textstück eine eigene Zeile mit Ausrichtung; Zeilen können sich eine Grundlinie teilen.
+constexpr LayoutSpec kLayouts[] = {
+    // STATUS: Boot- und Statusmeldungen
+    {5, {{14, u8g2_font_ncenB08_tr, TextAlign::LEFT, 0},
+         {28, u8g2_font_ncenB08_tr, TextAlign::LEFT, 0},
+         {42, u8g2_font_ncenB08_tr, TextAlign::LEFT, 0},
+         {56, u8g2_font_ncenB08_tr, TextAlign::LEFT, 0},
+         {64, u8g2_font_ncenB08_tr, TextAlign::LEFT, 0}}},
+    // CHOOSE_EXERCISE: Überschrift, Name der Übung, WiFi-Status
+    {3, {{20, u8g2_font_crox1tb_tf, TextAlign::LEFT, 0},
+         {46, u8g2_font_crox5tb_tf, TextAlign::LEFT, 0},
+         {64, u8g2_font_crox1tb_tf, TextAlign::RIGHT, 0}}},
+    // TIMER: Phase, Einheiten, Countdown, Satz | Wdh. | Intensität, Pause | WiFi
+    {8, {{10, u8g2_font_crox1tb_tf, TextAlign::LEFT, 0},
+         {20, u8g2_font_crox1tb_tf, TextAlign::LEFT, 0},
+         {40, u8g2_font_crox5tb_tf, TextAlign::LEFT, 0},
+         {50, u8g2_font_crox1tb_tf, TextAlign::LEFT, 0},
+         {50, u8g2_font_crox1tb_tf, TextAlign::CENTER, 0},
+         {50, u8g2_font_crox1tb_tf, TextAlign::RIGHT, 0},
+         {64, u8g2_font_crox1tb_tf, TextAlign::LEFT, 0},
+         {64, u8g2_font_crox1tb_tf, TextAlign::RIGHT, 0}}},
+};
+
+static_assert(sizeof(kLayouts) / sizeof(kLayouts[0]) == static_cast<size_t>(ScreenLayout::CUSTOM),
+              "ein Layout je ScreenLayout");
+
+} // namespace
 
 bool DisplayService::begin() {
     Wire.begin(kSdaPin, kSclPin);
@@ -12,29 +59,32 @@ bool DisplayService::begin() {
     display_.setFont(kDefaultFont);
     display_.setFontMode(1);
     display_.setDrawColor(1);
-    resetLayout();
+    buildGlyphCache();
+    useLayout(ScreenLayout::STATUS);
     clearLines();
     render();
     return true;
 }
 
 void DisplayService::showBootScreen() {
+    useLayout(ScreenLayout::STATUS);
     clearLines();
-    setLineInternal(0, String("IntervalTimer"));
-    setLineInternal(1, String("Display bereit"));
+    setLineInternal(0, "IntervalTimer");
+    setLineInternal(1, "Display bereit");
     render();
 }
 
 void DisplayService::showStatus(const char* line1, const char* line2, const char* line3) {
+    useLayout(ScreenLayout::STATUS);
     clearLines();
     if (line1) {
-        setLineInternal(0, String(line1));
+        setLineInternal(0, line1);
     }
     if (line2) {
-        setLineInternal(1, String(line2));
+        setLineInternal(1, line2);
     }
     if (line3) {
-        setLineInternal(2, String(line3));
+        setLineInternal(2, line3);
     }
     render();
 }
@@ -44,24 +94,24 @@ void DisplayService::clear() {
     render();
 }
 
-void DisplayService::chooseExercise(const Exercise* exercise, WifiState wifiState) {
-    clearLines();
-    String exerciseName = exercise ? String(exercise->name.c_str()) : String("Keine Uebung gewählt");
+void DisplayService::chooseExercise(const ExerciseSummary& exercise, WifiState wifiState) {
+    useLayout(ScreenLayout::CHOOSE_EXERCISE);
     const char* wifiText = (wifiState == WifiState::ACTIVE) ? "WiFi: Aktiv" : "WiFi: Inaktiv";
 
-    configureLine(0, 20, u8g2_font_crox1tb_tf );   // 9px Schrift
-    configureLine(1, 46, u8g2_font_crox5tb_tf);     // 16px Schrift
-    configureLine(2, 64, u8g2_font_crox1tb_tf );     // 9px für WiFi-Status
     setLine(0, "Uebung", false);
-    setLine(1, exerciseName, false);
-    setLine(2, String("                   ") + wifiText, false);
+    if (exercise) {
+        // Name liegt ohne Nullterminator im Index
+        setLinef(1, "%.*s", static_cast<int>(exercise.name.size), exercise.name.data);
+    } else {
+        setLine(1, "Keine Uebung gewählt", false);
+    }
+    setLine(2, wifiText, false);
     refresh();
 }
 
-void DisplayService::playTimer(const Exercise* exercise, unsigned long timeMillis, const ExerciseRuntime& runtime, WifiState wifiState) {
-    // String exerciseName = exercise ? String(exercise->name.c_str()) : String("Keine Uebung gewählt");
-    
-    String topText = "";
+void DisplayService::playTimer(unsigned long timeMillis, const ExerciseRuntime& runtime, int percentMaxIntensity, WifiState wifiState) {
+    // Alle Texte landen per snprintf direkt in den Zeilenpuffern, der Countdown allokiert nichts.
+    const char* topText = "";
     if(runtime.phase == RepState::PRE){
         // Vorbereitungsphase
         topText = "Get Ready";
@@ -76,55 +126,141 @@ void DisplayService::playTimer(const Exercise* exercise, unsigned long timeMilli
         topText = "Set Pause";
     }
     const char* wifiText = (wifiState == WifiState::ACTIVE) ? "WiFi: Aktiv" : "WiFi: Inaktiv";
-    const char* pauseText = runtime.paused ? " PAUSED" : "      ";
-    String setRepPercentText = "Set" + String(runtime.setIndex + 1) + "     Rep" + String(runtime.repIndex + 1) + "     " + String(exercise->sets[runtime.setIndex].percentMaxIntensity) + "%";
-
-    unsigned long totalSeconds = timeMillis / 1000;
-    unsigned long minutes = totalSeconds / 60;
-    unsigned long seconds = totalSeconds % 60;
-    unsigned long decimals = (timeMillis % 1000) / 10;
-    char timeString[9];
-    sprintf(timeString, "%02lu:%02lu:%02lu", minutes, seconds, decimals);
-    
-    
-    configureLine(0, 10, u8g2_font_crox1tb_tf ); // 9px Schrift
-    configureLine(1, 20, u8g2_font_crox1tb_tf ); // 9px Schrift
-    configureLine(2, 40, u8g2_font_crox5tb_tf); // 16px Schrift
-    configureLine(3, 50, u8g2_font_crox1tb_tf ); // 9px Schrift    
-    configureLine(4, 64, u8g2_font_crox1tb_tf ); // 9px Schrift
+    const char* pauseText = runtime.paused ? "PAUSED" : "";
 
+    useLayout(ScreenLayout::TIMER);
     setLine(0, topText, false);
-    setLine(1, "mm   :    ss   :    cc", false);
-    setLine(2, String(timeString), false);
-    setLine(3, setRepPercentText, false);
-    setLine(4, pauseText + String("             ") + wifiText, false);
+    if (countdownResolutionMs(runtime.phase, timeMillis) == kFineResolutionMs) {
+        unsigned long totalSeconds = timeMillis / 1000;
+        unsigned long decimals = (timeMillis % 1000) / 10;
+        setLine(1, "mm   :    ss   :    cc", false);
+        setLinef(2, "%02lu:%02lu:%02lu", totalSeconds / 60, totalSeconds % 60, decimals);
+    } else {
+        // Ganze Sekunden aufgerundet: 0 erscheint erst, wenn die Phase wirklich vorbei ist
+        unsigned long totalSeconds = (timeMillis + kCoarseResolutionMs - 1) / kCoarseResolutionMs;
+        setLine(1, "mm   :    ss", false);
+        setLinef(2, "%02lu:%02lu", totalSeconds / 60, totalSeconds % 60);
+    }
+    setLinef(3, "Set%u", static_cast<unsigned>(runtime.setIndex + 1));
+    setLinef(4, "Rep%u", static_cast<unsigned>(runtime.repIndex + 1));
+    setLinef(5, "%d%%", percentMaxIntensity);
+    setLine(6, pauseText, false);
+    setLine(7, wifiText, false);
+    refresh();
+}
+
+uint32_t DisplayService::fineWindowMs(RepState phase) const {
+    switch (phase) {
+    case RepState::PRE:
+        return pacing_.finePreparation ? UINT32_MAX : 0;
+    case RepState::IN_PROGRESS:
+        return pacing_.hangFineWindowMs;
+    default:
+        return pacing_.restFineWindowMs;
+    }
+}
+
+uint32_t DisplayService::countdownResolutionMs(RepState phase, uint32_t remainingMs) const {
+    const uint32_t window = fineWindowMs(phase);
+    return window > 0 && remainingMs <= window ? kFineResolutionMs : kCoarseResolutionMs;
+}
+
+// Zeit bis remainingMs / resolutionMs (abgerundet) wechselt. Bei feiner Auflösung werden Werte
+// übersprungen, damit höchstens alle minFrameIntervalMs ein Bild entsteht.
+uint32_t DisplayService::alignedFrameDelay(uint32_t remainingMs, uint32_t resolutionMs) const {
+    uint32_t delay = remainingMs % resolutionMs + 1;
+    if (resolutionMs < pacing_.minFrameIntervalMs && delay < pacing_.minFrameIntervalMs) {
+        const uint32_t steps = (pacing_.minFrameIntervalMs - delay + resolutionMs - 1) / resolutionMs;
+        delay += steps * resolutionMs;
+    }
+    return delay;
+}
+
+uint32_t DisplayService::untilNextTimerFrame(RepState phase, uint32_t remainingMs) const {
+    const uint32_t window = fineWindowMs(phase);
+    if (window > 0 && remainingMs <= window) {
+        return alignedFrameDelay(remainingMs, kFineResolutionMs);
+    }
+    // Sekundenanzeige rundet auf, wechselt also beim Unterschreiten eines vollen Sekundenwerts
+    uint32_t delay = alignedFrameDelay(remainingMs + kCoarseResolutionMs - 1, kCoarseResolutionMs);
+    if (window > 0) {
+        // rechtzeitig auf Hundertstel umschalten
+        delay = std::min(delay, remainingMs - window);
+    }
+    return delay;
+}
+
+// Der letzte Timer-Stand bleibt stehen, groß "PAUSE" ersetzt die Einheitenzeile. Das verlässt das
+// TIMER-Layout; playTimer() stellt es beim Fortsetzen wieder her.
+void DisplayService::showPause() {
+    setLine(1, "PAUSE", u8g2_font_ncenB24_tr, 48, false);
     refresh();
 }
 
+void DisplayService::useLayout(ScreenLayout layout) {
+    static_assert(kLayoutSlots == kDefaultLineCount, "Layout-Tabelle passt nicht zur Zeilenzahl");
+    if (layout == layout_ || layout == ScreenLayout::CUSTOM) {
+        return;
+    }
+    const LayoutSpec& spec = kLayouts[static_cast<size_t>(layout)];
+    for (uint8_t i = 0; i < lines_.size(); ++i) {
+        Line& line = lines_[i];
+        // Texte des vorherigen Layouts gehören nicht zum neuen Bildschirm
+        line.text[0] = '\0';
+        line.visible = false;
+        if (i < spec.lineCount) {
+            line.baseline = spec.slots[i].baseline;
+            line.font = spec.slots[i].font;
+            line.align = spec.slots[i].align;
+            line.offset = spec.slots[i].offset;
+        }
+    }
+    layout_ = layout;
+    dirty_ = true;
+}
+
 void DisplayService::configureLine(uint8_t line, uint8_t baseline, const uint8_t* font) {
     if (line >= lines_.size()) {
         return;
     }
+    const uint8_t* resolved = font ? font : kDefaultFont;
+    if (lines_[line].baseline == baseline && lines_[line].font == resolved) {
+        return;
+    }
+    // Einzelne Zeilen umzustellen verlässt das feste Layout, der nächste useLayout() greift wieder
+    layout_ = ScreenLayout::CUSTOM;
     lines_[line].baseline = baseline;
-    lines_[line].font = font ? font : kDefaultFont;
+    lines_[line].font = resolved;
     dirty_ = true;
 }
 
-void DisplayService::setLine(uint8_t line, const String& text, bool autoRefresh) {
+void DisplayService::setLine(uint8_t line, const char* text, bool autoRefresh) {
     setLineInternal(line, text);
     if (autoRefresh) {
         render();
     }
 }
 
-void DisplayService::setLine(uint8_t line, const String& text, const uint8_t* font, uint8_t baseline, bool autoRefresh) {
+void DisplayService::setLinef(uint8_t line, const char* format, ...) {
+    if (line >= lines_.size()) {
+        return;
+    }
+    char text[kLineCapacity];
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    setLineInternal(line, text);
+}
+
+void DisplayService::setLine(uint8_t line, const char* text, const uint8_t* font, uint8_t baseline, bool autoRefresh) {
     setLineInternal(line, text, font ? font : kDefaultFont, baseline);
     if (autoRefresh) {
         render();
     }
 }
 
-void DisplayService::printText(uint8_t lineFrom, uint8_t lineTo, const String& text) {
+void DisplayService::printText(uint8_t lineFrom, uint8_t lineTo, const char* text) {
     if (lineFrom > lineTo) {
         std::swap(lineFrom, lineTo);
     }
@@ -144,54 +280,389 @@ void DisplayService::refresh() {
 
 void DisplayService::clearLines() {
     for (auto& line : lines_) {
-        line.text = "";
+        if (line.visible) {
+            dirty_ = true;
+        }
+        line.text[0] = '\0';
         line.visible = false;
     }
-    dirty_ = true;
-}
-
-void DisplayService::resetLayout() {
-    // Default four lines roughly evenly spaced.
-    const std::array<uint8_t, kDefaultLineCount> defaults{14, 28, 42, 56, 64};
-    for (size_t i = 0; i < lines_.size(); ++i) {
-        lines_[i].baseline = defaults[i];
-        lines_[i].font = kDefaultFont;
-    }
 }
 
-void DisplayService::setLineInternal(uint8_t line, const String& text) {
+void DisplayService::setLineInternal(uint8_t line, const char* text) {
     if (line >= lines_.size()) {
         return;
     }
-    lines_[line].text = text;
-    lines_[line].visible = !text.isEmpty();
+    text = text ? text : "";
+    if (std::strncmp(lines_[line].text, text, kLineCapacity - 1) == 0) {
+        return;
+    }
+    // kürzt zu lange Texte auf die Zeilenkapazität
+    std::snprintf(lines_[line].text, kLineCapacity, "%s", text);
+    lines_[line].visible = lines_[line].text[0] != '\0';
     dirty_ = true;
 }
 
-void DisplayService::setLineInternal(uint8_t line, const String& text, const uint8_t* font, uint8_t baseline) {
+void DisplayService::setLineInternal(uint8_t line, const char* text, const uint8_t* font, uint8_t baseline) {
     if (line >= lines_.size()) {
         return;
     }
-    lines_[line].text = text;
-    lines_[line].font = font ? font : kDefaultFont;
-    lines_[line].baseline = baseline;
-    lines_[line].visible = !text.isEmpty();
-    dirty_ = true;
+    configureLine(line, baseline, font);
+    setLineInternal(line, text);
 }
 
 void DisplayService::render() {
-    if (!dirty_) {
+    count(stats_.framesRequested);
+    // Kein Bild neu zeichnen, wenn sich gegenüber dem zuletzt übergebenen nichts geändert hat
+    // (z. B. clearLines() gefolgt von denselben Texten in chooseExercise).
+    if (publishedValid_ && (!dirty_ || lines_ == published_)) {
+        count(stats_.framesSkipped);
+        dirty_ = false;
         return;
     }
+    published_ = lines_;
+    publishedValid_ = true;
+    dirty_ = false;
+
+    TaskHandle_t flushTask = flushTask_.load(std::memory_order_acquire);
+    if (!flushTask) {
+        // Vor dem Start des Display-Tasks (begin(), Bootscreen) synchron zeichnen
+        drawing_ = lines_;
+        drawFrame();
+        return;
+    }
+
+    portENTER_CRITICAL(&mailboxLock_);
+    if (mailboxFull_) {
+        count(stats_.framesDropped);
+    }
+    mailbox_ = lines_;
+    mailboxFull_ = true;
+    portEXIT_CRITICAL(&mailboxLock_);
+    xTaskNotifyGive(flushTask);
+}
+
+DisplayService::Stats DisplayService::stats() const {
+    Stats snapshot;
+    snapshot.framesRequested = stats_.framesRequested.load(std::memory_order_relaxed);
+    snapshot.framesRendered = stats_.framesRendered.load(std::memory_order_relaxed);
+    snapshot.framesSkipped = stats_.framesSkipped.load(std::memory_order_relaxed);
+    snapshot.framesDropped = stats_.framesDropped.load(std::memory_order_relaxed);
+    snapshot.framesPartial = stats_.framesPartial.load(std::memory_order_relaxed);
+    snapshot.transfers = stats_.transfers.load(std::memory_order_relaxed);
+    snapshot.tilesSent = stats_.tilesSent.load(std::memory_order_relaxed);
+    snapshot.bytesSent = stats_.bytesSent.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void DisplayService::resetStats() {
+    stats_.framesRequested.store(0, std::memory_order_relaxed);
+    stats_.framesRendered.store(0, std::memory_order_relaxed);
+    stats_.framesSkipped.store(0, std::memory_order_relaxed);
+    stats_.framesDropped.store(0, std::memory_order_relaxed);
+    stats_.framesPartial.store(0, std::memory_order_relaxed);
+    stats_.transfers.store(0, std::memory_order_relaxed);
+    stats_.tilesSent.store(0, std::memory_order_relaxed);
+    stats_.bytesSent.store(0, std::memory_order_relaxed);
+}
+
+void DisplayService::attachFlushTask() {
+    flushTask_.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+}
+
+bool DisplayService::flushPending(uint32_t timeoutMs) {
+    const TickType_t ticks = timeoutMs == kWaitForever ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    ulTaskNotifyTake(pdTRUE, ticks);
+
+    bool hasFrame = false;
+    portENTER_CRITICAL(&mailboxLock_);
+    if (mailboxFull_) {
+        drawing_ = mailbox_;
+        mailboxFull_ = false;
+        hasFrame = true;
+    }
+    portEXIT_CRITICAL(&mailboxLock_);
+
+    if (hasFrame) {
+        drawFrame();
+    }
+    return hasFrame;
+}
 
+void DisplayService::drawFrame() {
+    if (drawChangedDigits()) {
+        drawn_ = drawing_;
+        flushChangedTiles();
+        count(stats_.framesRendered);
+        count(stats_.framesPartial);
+        return;
+    }
+
+    std::array<int16_t, kDefaultLineCount> xs{};
     display_.clearBuffer();
-    for (const auto& line : lines_) {
-        if (line.visible) {
+    for (size_t i = 0; i < drawing_.size(); ++i) {
+        const Line& line = drawing_[i];
+        if (!line.visible) {
+            continue;
+        }
+        xs[i] = lineX(i, line);
+        if (usesGlyphCache(line)) {
+            blitText(xs[i], line.baseline, line.text);
+        } else {
             display_.setFont(line.font ? line.font : kDefaultFont);
-            display_.drawStr(0, line.baseline, line.text.c_str());
+            display_.drawStr(xs[i], line.baseline, line.text);
         }
     }
+    drawn_ = drawing_;
+    drawnX_ = xs;
+    drawnValid_ = true;
 
-    display_.sendBuffer();
-    dirty_ = false;
+    flushChangedTiles();
+    count(stats_.framesRendered);
+}
+
+// x-Position einer Zeile gemäß Ausrichtung. Die Textbreite wird nur gemessen, wenn sich die
+// Zeile seit dem letzten Bild geändert hat; bei linksbündigen Zeilen gar nicht.
+int16_t DisplayService::lineX(size_t index, const Line& line) {
+    if (line.align == TextAlign::LEFT) {
+        return line.offset;
+    }
+    if (drawnValid_ && drawn_[index] == line) {
+        return drawnX_[index];
+    }
+    int width = 0;
+    if (usesGlyphCache(line)) {
+        for (const char* c = line.text; *c; ++c) {
+            width += glyphs_[glyphIndex(*c)].advance;
+        }
+    } else {
+        display_.setFont(line.font ? line.font : kDefaultFont);
+        width = display_.getStrWidth(line.text);
+    }
+    const int displayWidth = display_.getDisplayWidth();
+    const int x = line.align == TextAlign::RIGHT ? displayWidth - width - line.offset
+                                                 : (displayWidth - width) / 2 + line.offset;
+    return static_cast<int16_t>(std::max(0, x));
+}
+
+// Zeichnet die Glyphen "0-9" und ":" der Countdown-Schrift einmal in den Framebuffer und
+// liest sie spaltenweise aus; danach muss U8g2 die Schrift für den Countdown nicht mehr dekodieren.
+void DisplayService::buildGlyphCache() {
+    glyphCacheValid_ = false;
+    display_.setFont(kCountdownFont);
+    const int ascent = display_.getAscent();
+    const int height = ascent - display_.getDescent();
+    if (ascent <= 0 || height <= 0 || height > 32 || height > display_.getDisplayHeight()) {
+        return;
+    }
+    glyphAscent_ = static_cast<int8_t>(ascent);
+    glyphHeight_ = static_cast<uint8_t>(height);
+    glyphInkMask_ = 0;
+
+    const uint8_t* buffer = display_.getBufferPtr();
+    const size_t rowBytes = display_.getBufferTileWidth() * 8;
+    for (uint8_t i = 0; i < kCachedGlyphCount; ++i) {
+        display_.clearBuffer();
+        const uint16_t advance = display_.drawGlyph(0, ascent, static_cast<uint8_t>(kCachedGlyphs[i]));
+        if (advance == 0 || advance > kMaxGlyphWidth) {
+            display_.clearBuffer();
+            return;
+        }
+        CachedGlyph& glyph = glyphs_[i];
+        glyph.advance = static_cast<uint8_t>(advance);
+        for (uint8_t x = 0; x < advance; ++x) {
+            uint32_t column = 0;
+            for (uint8_t y = 0; y < height; ++y) {
+                if (buffer[(y / 8) * rowBytes + x] & (1u << (y % 8))) {
+                    column |= 1UL << y;
+                }
+            }
+            glyph.columns[x] = column;
+            glyphInkMask_ |= column;
+        }
+    }
+    display_.clearBuffer();
+    glyphCacheValid_ = true;
+}
+
+void DisplayService::setGlyphCacheEnabled(bool enabled) {
+    if (enabled) {
+        buildGlyphCache();
+    } else {
+        glyphCacheValid_ = false;
+    }
+    // Framebuffer und Ziffernzellen passen nicht mehr zusammen, nächstes Bild komplett zeichnen
+    drawnValid_ = false;
+    publishedValid_ = false;
+}
+
+int8_t DisplayService::glyphIndex(char c) const {
+    for (uint8_t i = 0; i < kCachedGlyphCount; ++i) {
+        if (kCachedGlyphs[i] == c) {
+            return static_cast<int8_t>(i);
+        }
+    }
+    return -1;
+}
+
+bool DisplayService::usesGlyphCache(const Line& line) const {
+    if (!glyphCacheValid_ || line.font != kCountdownFont || line.text[0] == '\0') {
+        return false;
+    }
+    for (const char* c = line.text; *c; ++c) {
+        if (glyphIndex(*c) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Kopiert gecachte Glyphen direkt in die Pages des Framebuffers (transparent, wie FontMode 1).
+uint16_t DisplayService::blitText(int x, int baseline, const char* text) {
+    uint8_t* buffer = display_.getBufferPtr();
+    const int width = display_.getDisplayWidth();
+    const int rows = display_.getBufferTileHeight();
+    const int top = baseline - glyphAscent_;
+    uint16_t advance = 0;
+    for (const char* c = text; *c; ++c) {
+        const CachedGlyph& glyph = glyphs_[glyphIndex(*c)];
+        for (uint8_t col = 0; col < glyph.advance; ++col) {
+            const int px = x + advance + col;
+            if (px < 0 || px >= width || glyph.columns[col] == 0) {
+                continue;
+            }
+            const uint64_t bits = top >= 0 ? static_cast<uint64_t>(glyph.columns[col]) << top
+                                           : static_cast<uint64_t>(glyph.columns[col]) >> -top;
+            for (int page = 0; page < rows; ++page) {
+                const uint8_t byte = static_cast<uint8_t>(bits >> (page * 8));
+                if (byte) {
+                    buffer[page * width + px] |= byte;
+                }
+            }
+        }
+        advance = static_cast<uint16_t>(advance + glyph.advance);
+    }
+    return advance;
+}
+
+// Löscht in den Spalten [x, x + width) alle Zeilen, in denen gecachte Glyphen Pixel haben können.
+void DisplayService::clearColumns(int x, int width, int baseline) {
+    uint8_t* buffer = display_.getBufferPtr();
+    const int displayWidth = display_.getDisplayWidth();
+    const int rows = display_.getBufferTileHeight();
+    const int top = baseline - glyphAscent_;
+    const uint64_t bits = top >= 0 ? static_cast<uint64_t>(glyphInkMask_) << top
+                                   : static_cast<uint64_t>(glyphInkMask_) >> -top;
+    for (int px = std::max(0, x); px < std::min(displayWidth, x + width); ++px) {
+        for (int page = 0; page < rows; ++page) {
+            const uint8_t byte = static_cast<uint8_t>(bits >> (page * 8));
+            if (byte) {
+                buffer[page * displayWidth + px] &= static_cast<uint8_t>(~byte);
+            }
+        }
+    }
+}
+
+bool DisplayService::bandOverlaps(const Line& digits, const Line& other) {
+    display_.setFont(other.font ? other.font : kDefaultFont);
+    const int otherTop = other.baseline - display_.getAscent();
+    const int otherBottom = other.baseline - display_.getDescent();
+    const int top = digits.baseline - glyphAscent_;
+    const int bottom = top + glyphHeight_;
+    return otherTop < bottom && top < otherBottom;
+}
+
+// Teil-Update: Ändert sich gegenüber dem Framebuffer nur der Text einer Countdown-Zeile,
+// werden nur die geänderten Ziffernzellen gelöscht und neu geblittet.
+bool DisplayService::drawChangedDigits() {
+    if (!drawnValid_ || !glyphCacheValid_) {
+        return false;
+    }
+
+    int changed = -1;
+    for (size_t i = 0; i < drawing_.size(); ++i) {
+        if (drawing_[i] == drawn_[i]) {
+            continue;
+        }
+        if (changed >= 0) {
+            return false;
+        }
+        changed = static_cast<int>(i);
+    }
+    if (changed < 0) {
+        return false;
+    }
+
+    const Line& next = drawing_[changed];
+    const Line& prev = drawn_[changed];
+    if (!next.visible || !prev.visible || !usesGlyphCache(next) || !usesGlyphCache(prev) ||
+        next.baseline != prev.baseline || std::strlen(next.text) != std::strlen(prev.text)) {
+        return false;
+    }
+    for (size_t i = 0; i < drawing_.size(); ++i) {
+        if (static_cast<int>(i) != changed && drawing_[i].visible && bandOverlaps(next, drawing_[i])) {
+            return false;
+        }
+    }
+    // Verschiebt die Ausrichtung den Text, stimmt keine Ziffernzelle mehr
+    int x = lineX(changed, next);
+    if (x != drawnX_[changed]) {
+        return false;
+    }
+
+    for (size_t i = 0; next.text[i]; ++i) {
+        const CachedGlyph& oldGlyph = glyphs_[glyphIndex(prev.text[i])];
+        const CachedGlyph& newGlyph = glyphs_[glyphIndex(next.text[i])];
+        if (oldGlyph.advance != newGlyph.advance) {
+            // Proportionale Breiten: ab hier verschiebt sich alles, den Rest komplett neu zeichnen
+            clearColumns(x, display_.getDisplayWidth() - x, next.baseline);
+            blitText(x, next.baseline, next.text + i);
+            return true;
+        }
+        if (prev.text[i] != next.text[i]) {
+            clearColumns(x, newGlyph.advance, next.baseline);
+            const char cell[2] = {next.text[i], '\0'};
+            blitText(x, next.baseline, cell);
+        }
+        x += newGlyph.advance;
+    }
+    return true;
+}
+
+// Vergleicht den Framebuffer kachelweise (8x8 px = 8 Bytes einer Page) mit dem zuletzt
+// übertragenen Stand und schickt nur zusammenhängende Läufe geänderter Kacheln.
+void DisplayService::flushChangedTiles() {
+    uint8_t* buffer = display_.getBufferPtr();
+    constexpr size_t kRowBytes = kTileColumns * 8;
+
+    if (!panelValid_) {
+        display_.sendBuffer();
+        std::memcpy(panel_.data(), buffer, kFrameBytes);
+        panelValid_ = true;
+        count(stats_.transfers);
+        count(stats_.tilesSent, kTileColumns * kTileRows);
+        count(stats_.bytesSent, kFrameBytes + kTileRows * kTransferOverheadBytes);
+        return;
+    }
+
+    for (uint8_t ty = 0; ty < kTileRows; ++ty) {
+        const size_t rowOffset = ty * kRowBytes;
+        uint8_t tx = 0;
+        while (tx < kTileColumns) {
+            if (std::memcmp(buffer + rowOffset + tx * 8, panel_.data() + rowOffset + tx * 8, 8) == 0) {
+                ++tx;
+                continue;
+            }
+            const uint8_t start = tx;
+            while (tx < kTileColumns &&
+                   std::memcmp(buffer + rowOffset + tx * 8, panel_.data() + rowOffset + tx * 8, 8) != 0) {
+                ++tx;
+            }
+            const uint8_t width = tx - start;
+            display_.updateDisplayArea(start, ty, width, 1);
+            std::memcpy(panel_.data() + rowOffset + start * 8, buffer + rowOffset + start * 8, width * 8);
+            count(stats_.transfers);
+            count(stats_.tilesSent, width);
+            count(stats_.bytesSent, width * 8 + kTransferOverheadBytes);
+        }
+    }
 }
@@ -1,45 +1,189 @@
 #pragma once
 #include "models/datastructures.h"
+#include "models/exerciseview.h"
 
 #include <Arduino.h>
 #include <U8g2lib.h>
 #include <array>
+#include <atomic>
+#include <cstring>
+
+// Horizontale Ausrichtung einer Zeile; der Versatz im Layout zählt jeweils vom Bezugspunkt
+// (linker Rand, Mitte bzw. rechter Rand) aus.
+enum class TextAlign : uint8_t { LEFT, CENTER, RIGHT };
+
+// Feste Bildschirmaufteilungen, siehe kLayouts in displayservice.cpp
+enum class ScreenLayout : uint8_t { STATUS, CHOOSE_EXERCISE, TIMER, CUSTOM };
 
 class DisplayService {
 public:
+    static constexpr uint32_t kWaitForever = UINT32_MAX;
+
     bool begin();
     void showBootScreen();
     void showStatus(const char* line1, const char* line2 = nullptr, const char* line3 = nullptr);
     void showCountdown(const char* label, unsigned long timeMillis);
     void clear();
 
-    void chooseExercise(const Exercise* exercise, WifiState wifiState);
-    void playTimer (const Exercise* exercise, unsigned long timeMillis, const ExerciseRuntime& runtime, WifiState wifiState);
+    void chooseExercise(const ExerciseSummary& exercise, WifiState wifiState);
+    void playTimer(unsigned long timeMillis, const ExerciseRuntime& runtime, int percentMaxIntensity, WifiState wifiState);
+    void showPause();
+    // Wechselt Schrift, Grundlinie und Ausrichtung aller Zeilen auf einmal; ohne Wechsel ein No-op.
+    void useLayout(ScreenLayout layout);
+
+    // Bildrate des Countdowns: Hundertstel nur dort, wo es darauf ankommt, sonst ganze
+    // Sekunden mit 1 Hz (lange Pausen machen den Großteil einer Einheit aus).
+    struct FramePacing {
+        uint32_t minFrameIntervalMs = 25;  // höchstens 40 Bilder pro Sekunde
+        uint32_t hangFineWindowMs = 5000;  // Wiederholung: Hundertstel in den letzten 5 s
+        uint32_t restFineWindowMs = 0;     // Pause/Satzpause: 0 = durchgehend Sekunden
+        bool finePreparation = true;       // Get-Ready-Countdown durchgehend mit Hundertstel
+    };
+    void setFramePacing(const FramePacing& pacing) { pacing_ = pacing; }
+    // Ohne Cache zeichnet jedes Bild die Countdown-Ziffern komplett per drawStr() (Vergleich in --bench)
+    void setGlyphCacheEnabled(bool enabled);
+    const FramePacing& framePacing() const { return pacing_; }
+    uint32_t countdownResolutionMs(RepState phase, uint32_t remainingMs) const;
+    // Zeit, bis playTimer() in derselben Phase ein anderes Bild zeigt; Deadline für den TimerScheduler.
+    uint32_t untilNextTimerFrame(RepState phase, uint32_t remainingMs) const;
     void configureLine(uint8_t line, uint8_t baseline, const uint8_t* font = nullptr);
-    void setLine(uint8_t line, const String& text, bool autoRefresh = true);
-    void setLine(uint8_t line, const String& text, const uint8_t* font, uint8_t baseline, bool autoRefresh = true);
-    void printText(uint8_t lineFrom, uint8_t lineTo, const String& text);
+    void setLine(uint8_t line, const char* text, bool autoRefresh = true);
+    void setLine(uint8_t line, const char* text, const uint8_t* font, uint8_t baseline, bool autoRefresh = true);
+    // printf-Variante ohne Heap: formatiert direkt in den Zeilenpuffer, rendert nicht automatisch
+    void setLinef(uint8_t line, const char* format, ...) __attribute__((format(printf, 3, 4)));
+    void printText(uint8_t lineFrom, uint8_t lineTo, const char* text);
     void refresh();
 
+    // Display-Task: nach attachFlushTask() zeichnet und überträgt nur noch dieser Task,
+    // render() legt das fertige Bild lediglich im Postfach ab.
+    void attachFlushTask();
+    bool flushPending(uint32_t timeoutMs);
+
+    struct Stats {
+        uint32_t framesRequested = 0; // render()-Aufrufe
+        uint32_t framesRendered = 0;  // tatsächlich gezeichnet und übertragen
+        uint32_t framesSkipped = 0;   // Inhalt identisch zum angezeigten Bild
+        uint32_t framesDropped = 0;   // vom nächsten Bild überholt, bevor der Display-Task es abholte
+        uint32_t framesPartial = 0;   // nur geänderte Countdown-Ziffern neu gezeichnet
+        uint32_t transfers = 0;   // updateDisplayArea()/sendBuffer()-Aufrufe
+        uint32_t tilesSent = 0;   // übertragene 8x8-Kacheln
+        uint32_t bytesSent = 0;   // geschätzte I2C-Bytes inkl. Adressierung
+    };
+    // Timer- und Display-Task zählen gleichzeitig: stats() liefert eine Momentaufnahme,
+    // resetStats() setzt jeden Zähler einzeln zurück
+    Stats stats() const;
+    void resetStats();
+
+#ifdef NATIVE_BUILD
+    // Host-Werkzeuge (native/displaytool.cpp) lesen das virtuelle Panel aus
+    const U8G2& device() const { return display_; }
+#endif
+
 private:
     static constexpr uint8_t kSdaPin = 6; // SDA on D4
     static constexpr uint8_t kSclPin = 7; // SCL on D5
-    static constexpr uint8_t kDefaultLineCount = 5;
+    static constexpr uint8_t kDefaultLineCount = 8;
+    static constexpr size_t kLineCapacity = 64; // inkl. Nullterminator
+    static constexpr uint8_t kTileColumns = 16;  // 128 px / 8
+    static constexpr uint8_t kTileRows = 8;      // 64 px / 8
+    static constexpr size_t kFrameBytes = kTileColumns * 8 * kTileRows;
+    static constexpr uint32_t kTransferOverheadBytes = 8; // Adresse, Control-Byte, Spalten-/Page-Kommandos
     static constexpr const uint8_t* kDefaultFont = u8g2_font_ncenB08_tr;
+    static constexpr const uint8_t* kCountdownFont = u8g2_font_crox5tb_tf;
+    static constexpr char kCachedGlyphs[] = "0123456789:";
+    static constexpr uint8_t kCachedGlyphCount = sizeof(kCachedGlyphs) - 1;
+    static constexpr uint8_t kMaxGlyphWidth = 24;
+    static constexpr uint32_t kFineResolutionMs = 10;      // mm:ss:cc
+    static constexpr uint32_t kCoarseResolutionMs = 1000;  // mm:ss
+
+    struct Line;
 
     void clearLines();
-    void resetLayout();
-    void setLineInternal(uint8_t line, const String& text);
-    void setLineInternal(uint8_t line, const String& text, const uint8_t* font, uint8_t baseline);
+    uint32_t fineWindowMs(RepState phase) const;
+    uint32_t alignedFrameDelay(uint32_t remainingMs, uint32_t resolutionMs) const;
+    void setLineInternal(uint8_t line, const char* text);
+    void setLineInternal(uint8_t line, const char* text, const uint8_t* font, uint8_t baseline);
     void render();
+    void drawFrame();
+    bool drawChangedDigits();
+    void buildGlyphCache();
+    bool usesGlyphCache(const Line& line) const;
+    int8_t glyphIndex(char c) const;
+    uint16_t blitText(int x, int baseline, const char* text);
+    void clearColumns(int x, int width, int baseline);
+    bool bandOverlaps(const Line& a, const Line& b);
+    int16_t lineX(size_t index, const Line& line);
+    void flushChangedTiles();
 
     U8G2_SSD1306_128X64_NONAME_F_HW_I2C display_{U8G2_R0, U8X8_PIN_NONE};
     struct Line {
-        String text;
+        char text[kLineCapacity] = {};
         const uint8_t* font = kDefaultFont;
         uint8_t baseline = 16;
+        TextAlign align = TextAlign::LEFT;
+        int8_t offset = 0;
         bool visible = false;
+
+        // Unsichtbare Zeilen werden nicht gezeichnet, ihr Inhalt spielt keine Rolle.
+        bool operator==(const Line& other) const {
+            if (visible != other.visible) {
+                return false;
+            }
+            return !visible || (baseline == other.baseline && font == other.font && align == other.align &&
+                                offset == other.offset && std::strcmp(text, other.text) == 0);
+        }
+        bool operator!=(const Line& other) const { return !(*this == other); }
     };
-    std::array<Line, kDefaultLineCount> lines_{};
+    using Frame = std::array<Line, kDefaultLineCount>;
+
+    // gehört dem aufrufenden Task (Timer), der die Bilder zusammensetzt
+    Frame lines_{};
+    ScreenLayout layout_ = ScreenLayout::CUSTOM;
+    FramePacing pacing_{};
+    Frame published_{};   // zuletzt an render() übergebenes Bild
+    bool publishedValid_ = false;
     bool dirty_ = false;
+
+    // Postfach mit dem jeweils neuesten Bild; ältere, nicht abgeholte Bilder werden ersetzt
+    Frame mailbox_{};
+    bool mailboxFull_ = false;
+    portMUX_TYPE mailboxLock_ = portMUX_INITIALIZER_UNLOCKED;
+    std::atomic<TaskHandle_t> flushTask_{nullptr};
+
+    // gehört dem zeichnenden Task (Display-Task bzw. vor dessen Start dem Aufrufer)
+    Frame drawing_{};
+    Frame drawn_{};       // Inhalt des aktuellen Framebuffers, Basis für Teil-Updates
+    std::array<int16_t, kDefaultLineCount> drawnX_{}; // x-Position je Zeile in drawn_, gilt solange die Zeile gleich bleibt
+    bool drawnValid_ = false;
+
+    // Einmal beim Start dekodierte Glyphen der großen Countdown-Schrift, spaltenweise als
+    // Bitmaske (Bit 0 = oberste Zeile ab baseline - ascent).
+    struct CachedGlyph {
+        uint8_t advance = 0;
+        std::array<uint32_t, kMaxGlyphWidth> columns{};
+    };
+    std::array<CachedGlyph, kCachedGlyphCount> glyphs_{};
+    int8_t glyphAscent_ = 0;
+    uint8_t glyphHeight_ = 0;
+    uint32_t glyphInkMask_ = 0;   // Zeilen, in denen irgendeine gecachte Glyphe Pixel hat
+    bool glyphCacheValid_ = false;
+
+    // Zuletzt an das Panel übertragener Framebuffer, Basis für den Kachel-Diff
+    std::array<uint8_t, kFrameBytes> panel_{};
+    bool panelValid_ = false;
+
+    struct Counters {
+        std::atomic<uint32_t> framesRequested{0};
+        std::atomic<uint32_t> framesRendered{0};
+        std::atomic<uint32_t> framesSkipped{0};
+        std::atomic<uint32_t> framesDropped{0};
+        std::atomic<uint32_t> framesPartial{0};
+        std::atomic<uint32_t> transfers{0};
+        std::atomic<uint32_t> tilesSent{0};
+        std::atomic<uint32_t> bytesSent{0};
+    };
+    static void count(std::atomic<uint32_t>& counter, uint32_t amount = 1) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+    Counters stats_;
 };
@@ -0,0 +1,59 @@
+#include "timerscheduler.h"
+#include "core/timebase.h"
+
+#include <algorithm>
+
+void TimerScheduler::attach() {
+    task_ = xTaskGetCurrentTaskHandle();
+}
+
+void TimerScheduler::notify() {
+    if (task_) {
+        xTaskNotifyGive(task_);
+    }
+}
+
+void TimerScheduler::setClock(NowFn now, WaitFn wait) {
+    now_ = now ? now : systemNow;
+    wait_ = wait ? wait : notifyWait;
+    lastWakeUs_ = 0; // stammt von der vorherigen Uhr
+}
+
+bool TimerScheduler::waitFor(uint32_t timeoutMs) {
+    if (lastWakeUs_ != 0) {
+        const uint64_t loopUs = now_() - lastWakeUs_;
+        maxLoopUs_ = std::max<uint32_t>(maxLoopUs_, loopUs > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(loopUs));
+    }
+    const bool notified = wait_(timeoutMs);
+    lastWakeUs_ = now_();
+    ++wakeups_;
+    if (notified) {
+        ++notifiedWakeups_;
+    }
+    return notified;
+}
+
+uint64_t TimerScheduler::systemNow() {
+    return monotonicMicros();
+}
+
+bool TimerScheduler::notifyWait(uint32_t timeoutMs) {
+    TickType_t ticks = portMAX_DELAY;
+    if (timeoutMs != kForever) {
+        // Aufrunden plus ein Tick, weil der laufende Tick schon angebrochen ist;
+        // so wird nie vor der Deadline geweckt.
+        ticks = timeoutMs == 0 ? 0 : (timeoutMs + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS + 1;
+    }
+    return ulTaskNotifyTake(pdTRUE, ticks) > 0;
+}
+
+uint32_t TimerScheduler::nextDeadline(uint32_t remainingMs, uint32_t frameDueMs) {
+    return std::min(remainingMs, frameDueMs);
+}
+
+void TimerScheduler::resetStats() {
+    wakeups_ = 0;
+    notifiedWakeups_ = 0;
+    maxLoopUs_ = 0;
+    lastWakeUs_ = 0; // der nächste Durchlauf zählt erst ab dem nächsten Aufwachen
+}
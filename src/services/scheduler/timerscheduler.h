@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+
+// Lässt den Timer-Task bis zur nächsten relevanten Deadline schlafen (Phasenende oder
+// sichtbarer Wechsel des Countdowns). Andere Tasks wecken ihn über notify() vorzeitig.
+class TimerScheduler {
+public:
+    static constexpr uint32_t kForever = UINT32_MAX;
+
+    // Zeitquelle und Warten des Timer-Tasks. Standard sind monotonicMicros() und die
+    // Task-Notification; der Host setzt hier eine simulierte Uhr ein (--timer-wakeups).
+    using NowFn = uint64_t (*)();
+    // Blockiert höchstens timeoutMs (kForever = unbegrenzt); true, wenn notify() weckte.
+    using WaitFn = bool (*)(uint32_t timeoutMs);
+    void setClock(NowFn now, WaitFn wait);
+    uint64_t nowUs() const { return now_(); }
+
+    void attach();
+    void notify();
+    // Blockiert bis timeoutMs verstrichen ist oder notify() kam; true bei notify().
+    bool waitFor(uint32_t timeoutMs);
+
+    // Frühere von Phasenende und nächstem fälligen Bild (siehe DisplayService::untilNextTimerFrame).
+    static uint32_t nextDeadline(uint32_t remainingMs, uint32_t frameDueMs);
+
+    uint32_t wakeups() const { return wakeups_; }
+    uint32_t notifiedWakeups() const { return notifiedWakeups_; }
+    // Längste Zeit zwischen Aufwachen und erneutem waitFor(), also ein Schleifendurchlauf des Tasks
+    uint32_t maxLoopUs() const { return maxLoopUs_; }
+    void resetStats();
+
+private:
+    static uint64_t systemNow();
+    static bool notifyWait(uint32_t timeoutMs);
+
+    NowFn now_ = systemNow;
+    WaitFn wait_ = notifyWait;
+    TaskHandle_t task_ = nullptr;
+    uint32_t wakeups_ = 0;
+    uint32_t notifiedWakeups_ = 0;
+    uint64_t lastWakeUs_ = 0;
+    uint32_t maxLoopUs_ = 0;
+};
@@ -0,0 +1,212 @@
+#include "persistenceworker.h"
+#include "core/timebase.h"
+
+#include <algorithm>
+
+namespace {
+uint32_t clampToUint32(uint64_t value) {
+    return value > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(value);
+}
+} // namespace
+
+PersistenceWorker::PersistenceWorker(StorageService& storage) : storage_(storage) {}
+
+void PersistenceWorker::begin() {
+    if (!mutex_) {
+        mutex_ = xSemaphoreCreateMutex();
+        commitMutex_ = xSemaphoreCreateMutex();
+    }
+}
+
+void PersistenceWorker::setPolicy(const Policy& policy) {
+    lock();
+    policy_ = policy;
+    unlock();
+    wake(); // ein laufendes Warten mit dem alten Fenster neu berechnen
+}
+
+PersistenceWorker::Policy PersistenceWorker::policy() const {
+    lock();
+    const Policy policy = policy_;
+    unlock();
+    return policy;
+}
+
+bool PersistenceWorker::flush() {
+    lock();
+    const bool clean = !dirty_ && storage_.pendingChanges() == 0;
+    unlock();
+    return clean || commit();
+}
+
+void PersistenceWorker::requestFlush() {
+    lock();
+    const bool pending = dirty_;
+    flushRequested_ = pending;
+    unlock();
+    if (pending) {
+        wake();
+    }
+}
+
+uint32_t PersistenceWorker::preload(const StorageService::ExerciseId& id) {
+    lock();
+    preloadId_ = id;
+    if (++preloadRequested_ == 0) {
+        ++preloadRequested_; // 0 bleibt frei für "kein Auftrag"
+    }
+    const uint32_t ticket = preloadRequested_;
+    unlock();
+    wake();
+    return ticket;
+}
+
+bool PersistenceWorker::preloaded(uint32_t ticket) const {
+    return static_cast<int32_t>(preloadDone_.load() - ticket) >= 0;
+}
+
+void PersistenceWorker::setPreloadListener(void (*listener)()) {
+    lock();
+    preloadListener_ = listener;
+    unlock();
+}
+
+void PersistenceWorker::run() {
+    task_ = xTaskGetCurrentTaskHandle();
+    for (;;) {
+        const uint32_t waitMs = poll(monotonicMicros());
+        // wie TimerScheduler::waitFor(): aufrunden plus ein Tick, damit nie vor dem Termin geschrieben wird
+        const TickType_t ticks =
+            waitMs == kForever ? portMAX_DELAY : (waitMs + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS + 1;
+        ulTaskNotifyTake(pdTRUE, ticks);
+    }
+}
+
+uint32_t PersistenceWorker::poll(uint64_t nowUs) {
+    lock();
+    uint32_t waitMs = kForever;
+    bool due = false;
+    if (dirty_ && flushRequested_) {
+        due = true;
+    } else if (dirty_) {
+        const uint64_t dueUs = std::min(lastChangeUs_ + policy_.quietMs * 1000ULL,
+                                        firstChangeUs_ + policy_.maxDelayMs * 1000ULL);
+        if (nowUs < dueUs) {
+            waitMs = clampToUint32((dueUs - nowUs + 999ULL) / 1000ULL);
+        } else {
+            due = true;
+        }
+    }
+    flushRequested_ = false;
+    const uint32_t retryMs = policy_.quietMs;
+    const uint32_t preloadTicket = preloadRequested_ != preloadTaken_ ? preloadRequested_ : 0;
+    const StorageService::ExerciseId preloadId = preloadId_;
+    void (*const listener)() = preloadListener_;
+    preloadTaken_ = preloadRequested_;
+    unlock();
+
+    // vor dem Commit: auf den Körper wartet jemand, auf das Schreiben nicht
+    if (preloadTicket != 0) {
+        storage_.find(preloadId);
+        preloadDone_.store(preloadTicket);
+        if (listener) {
+            listener();
+        }
+    }
+    if (due && !commit()) {
+        // NVS voll oder nicht erreichbar: nach einem weiteren Ruhefenster erneut versuchen
+        waitMs = retryMs;
+    }
+    return waitMs;
+}
+
+PersistenceWorker::Stats PersistenceWorker::stats() const {
+    lock();
+    Stats stats = stats_;
+    stats.pendingChanges = static_cast<uint32_t>(storage_.pendingChanges());
+    unlock();
+    return stats;
+}
+
+void PersistenceWorker::resetStats() {
+    lock();
+    stats_ = Stats{};
+    unlock();
+}
+
+// Ohne begin() (Host-Werkzeuge mit nur einem Thread) wird nicht gesperrt.
+void PersistenceWorker::lock() const {
+    if (mutex_) {
+        xSemaphoreTake(mutex_, portMAX_DELAY);
+    }
+}
+
+void PersistenceWorker::unlock() const {
+    if (mutex_) {
+        xSemaphoreGive(mutex_);
+    }
+}
+
+void PersistenceWorker::wake() {
+    if (TaskHandle_t task = task_.load()) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void PersistenceWorker::markDirtyLocked() {
+    const uint64_t nowUs = monotonicMicros();
+    if (!dirty_) {
+        dirty_ = true;
+        firstChangeUs_ = nowUs;
+    }
+    lastChangeUs_ = nowUs;
+    ++stats_.changes;
+}
+
+// Übernimmt den Stand unter dem Schreib-Lock und schreibt ihn danach ohne. Änderungen während
+// des Schreibens markieren den Worker erneut und landen im nächsten Commit.
+bool PersistenceWorker::commit() {
+    if (commitMutex_) {
+        xSemaphoreTake(commitMutex_, portMAX_DELAY);
+    }
+
+    StorageService::SaveBatch batch;
+    lock();
+    const bool pending = storage_.beginSave(batch);
+    const bool wasDirty = dirty_;
+    const uint64_t firstChangeUs = firstChangeUs_;
+    dirty_ = false;
+    unlock();
+
+    const uint64_t startUs = monotonicMicros();
+    const bool ok = !pending || storage_.writeSave(batch);
+    const uint64_t endUs = monotonicMicros();
+
+    lock();
+    if (pending) {
+        storage_.endSave(batch, ok);
+    }
+    stats_.lastCommitUs = clampToUint32(endUs - startUs);
+    stats_.maxCommitUs = std::max(stats_.maxCommitUs, stats_.lastCommitUs);
+    if (ok) {
+        ++stats_.commits;
+        if (wasDirty) {
+            stats_.lastLatencyMs = clampToUint32((endUs - firstChangeUs) / 1000ULL);
+            stats_.maxLatencyMs = std::max(stats_.maxLatencyMs, stats_.lastLatencyMs);
+        }
+    } else {
+        ++stats_.failures;
+        if (wasDirty) {
+            // bleibt fällig, gezählt ab der ältesten nicht geschriebenen Änderung
+            firstChangeUs_ = dirty_ ? std::min(firstChangeUs_, firstChangeUs) : firstChangeUs;
+            dirty_ = true;
+        }
+    }
+    unlock();
+
+    storage_.removeReleased(batch);
+    if (commitMutex_) {
+        xSemaphoreGive(commitMutex_);
+    }
+    return ok;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstdint>
+#include <freertos/semphr.h>
+
+#include "services/storage/storageservice.h"
+
+// Schreibt Änderungen am StorageService verzögert in einem eigenen Task. Die Web-Handler ändern
+// nur den RAM-Stand und antworten sofort; mehrere Änderungen kurz hintereinander landen in
+// einem gemeinsamen savePersistent() statt je einem Flash-Schreibvorgang.
+class PersistenceWorker {
+public:
+    static constexpr uint32_t kForever = UINT32_MAX;
+
+    // Geschrieben wird, sobald quietMs lang keine Änderung mehr kam, spätestens aber maxDelayMs
+    // nach der ersten noch nicht geschriebenen Änderung. Fällt der Strom vorher aus, gehen also
+    // höchstens die Änderungen der letzten maxDelayMs (Standard 5 s) verloren; requestFlush()
+    // verkürzt das Fenster an Stellen, an denen das Gerät gern ausgeschaltet wird.
+    struct Policy {
+        uint32_t quietMs = 1000;
+        uint32_t maxDelayMs = 5000;
+    };
+
+    struct Stats {
+        uint32_t changes = 0;        // über modify() gemeldete Änderungen
+        uint32_t commits = 0;        // erfolgreiche savePersistent()-Aufrufe
+        uint32_t failures = 0;
+        uint32_t pendingChanges = 0; // Übungen, die noch nicht im NVS stehen
+        uint32_t lastCommitUs = 0;   // Dauer von savePersistent()
+        uint32_t maxCommitUs = 0;
+        uint32_t lastLatencyMs = 0;  // erste Änderung bis zum Ende des Schreibens
+        uint32_t maxLatencyMs = 0;
+    };
+
+    explicit PersistenceWorker(StorageService& storage);
+
+    void begin(); // vor dem Start der Tasks aufrufen
+    void setPolicy(const Policy& policy);
+    Policy policy() const;
+
+    // Führt change(storage) unter dem Schreib-Lock aus. Liefert change true, gilt der Stand als
+    // geändert und der Worker wird geweckt; das Ergebnis von change wird durchgereicht.
+    template <typename Change>
+    bool modify(Change&& change) {
+        lock();
+        const bool changed = change(storage_);
+        if (changed) {
+            markDirtyLocked();
+        }
+        unlock();
+        if (changed) {
+            wake();
+        }
+        return changed;
+    }
+
+    // Schreibt Ausstehendes sofort im aufrufenden Task, z. B. bevor WLAN oder Gerät abschalten.
+    // Wie jeder Commit hält es den Schreib-Lock nur, solange der Stand übernommen wird; modify()
+    // wartet also nicht auf den Flash.
+    bool flush();
+    // Wie flush(), aber ohne zu blockieren: weckt den Persistenz-Task, der Ausstehendes sofort
+    // schreibt. Für Tasks, die selbst nicht ins NVS schreiben sollen (Timer-Task).
+    void requestFlush();
+
+    // Lädt den Körper der Übung im Persistenz-Task in den Cache, damit Tasks mit kleinem Stack sie
+    // über StorageService::resolveCached() bekommen, ohne selbst das NVS zu lesen. Ein neuer Auftrag
+    // ersetzt einen noch nicht bearbeiteten; nach jedem ruft der Worker den Listener auf.
+    // Liefert eine Auftragsnummer für preloaded().
+    uint32_t preload(const StorageService::ExerciseId& id);
+    // true, sobald dieser oder ein späterer Auftrag erledigt ist
+    bool preloaded(uint32_t ticket) const;
+    void setPreloadListener(void (*listener)());
+
+    // Schleife des Persistenz-Tasks, kehrt nicht zurück.
+    void run();
+    // Ein Durchlauf: schreibt, falls fällig, und liefert die Zeit in ms bis zum nächsten Termin.
+    uint32_t poll(uint64_t nowUs);
+
+    Stats stats() const;
+    void resetStats();
+
+private:
+    void lock() const;
+    void unlock() const;
+    void wake();
+    void markDirtyLocked();
+    bool commit();
+
+    StorageService& storage_;
+    SemaphoreHandle_t mutex_ = nullptr;       // Schreib-Lock: Änderungen und Zustand des Workers
+    SemaphoreHandle_t commitMutex_ = nullptr; // nur ein Commit zugleich (Persistenz-Task oder flush())
+    std::atomic<TaskHandle_t> task_{nullptr};
+    Policy policy_{};
+    Stats stats_{};
+    bool dirty_ = false;
+    bool flushRequested_ = false;
+    uint64_t firstChangeUs_ = 0; // älteste noch nicht geschriebene Änderung
+    uint64_t lastChangeUs_ = 0;
+    StorageService::ExerciseId preloadId_{};
+    uint32_t preloadRequested_ = 0; // Nummer des letzten Auftrags
+    uint32_t preloadTaken_ = 0;     // davon vom Persistenz-Task übernommen
+    void (*preloadListener_)() = nullptr;
+    std::atomic<uint32_t> preloadDone_{0};
+};
@@ -6,18 +6,32 @@
 #include <cstring>
 #include <utility>
 
+#include "models/timeline.h"
+
 #ifdef ESP_PLATFORM
 #include <esp_random.h>
-#include <Preferences.h>
 #else
 #include <cstdlib>
 #include <ctime>
 #endif
 
+// Auf dem Gerät kommt Preferences aus dem Arduino-Core, im native-Build aus dem Shim.
+#if defined(ESP_PLATFORM) || defined(NATIVE_BUILD)
+#include <Preferences.h>
+#define STORAGE_HAS_PREFERENCES 1
+#endif
+
 namespace {
 constexpr const char* kPrefsNamespace = "interval";
 constexpr const char* kPrefsKey = "exercises";
-constexpr uint16_t kStorageVersion = 1;
+constexpr const char* kJournalKeyPrefix = "j"; // Journal-Einträge j0 ... j<kJournalMaxRecords - 1>
+constexpr const char* kBodyKeyPrefix = "b";    // Übungskörper b0, b1, ... (Schlüssel im Index)
+constexpr size_t kNvsKeySize = 16;             // NVS erlaubt 15 Zeichen plus Nullterminator
+constexpr uint16_t kStorageVersion = 3;       // Snapshot enthält nur den Index, Körper unter eigenen Schlüsseln
+constexpr uint16_t kInlineStorageVersion = 2; // Varints, ganze Übungen im Snapshot
+constexpr uint16_t kLegacyStorageVersion = 1; // feste 16/32-Bit-Felder, jede Rep einzeln
+// Index-Felder eines Datensatzes: Schlüssel, Name, Anzahl Sets, Dauer
+constexpr size_t kMaxIndexFieldsBytes = 4 * varint::kMaxBytes + StorageService::kMaxExerciseNameLength;
 
 void appendUint16(std::vector<uint8_t>& buffer, uint16_t value) {
     buffer.push_back(static_cast<uint8_t>(value & 0xFF));
@@ -61,6 +75,19 @@ bool readBytes(const uint8_t* data, size_t length, size_t& offset, uint8_t* targ
     offset += count;
     return true;
 }
+
+// Felder eines Index-Datensatzes hinter der Id: Schlüssel des Körpers, Name, Anzahl Sets,
+// Dauer in Sekunden. Liefert die gelesene Länge, 0 bei beschädigten Daten.
+size_t readIndexFields(const uint8_t* data, size_t length, uint32_t& bodyKey, ExerciseSummary& summary) {
+    size_t offset = 0;
+    if (!varint::read(data, length, offset, bodyKey) || !varint::readText(data, length, offset, summary.name) ||
+        !varint::read(data, length, offset, summary.setCount) ||
+        !varint::read(data, length, offset, summary.durationS)) {
+        return 0;
+    }
+    summary.valid = true;
+    return offset;
+}
 } // namespace
 
 StorageService::StorageService() {
@@ -71,6 +98,18 @@ StorageService::StorageService() {
         seeded = true;
     }
 #endif
+    current_.store(new Library());
+    bodyMutex_ = xSemaphoreCreateMutex();
+}
+
+StorageService::~StorageService() {
+    // Beim Zerstören hält kein Leser mehr einen Stand
+    delete current_.load();
+    delete draft_;
+    for (const Library* library : retired_) {
+        delete library;
+    }
+    vSemaphoreDelete(bodyMutex_);
 }
 
 StorageService::ExerciseId StorageService::generateId() {
@@ -89,13 +128,113 @@ StorageService::ExerciseId StorageService::generateId() {
     return id;
 }
 
-bool StorageService::idExists(const ExerciseId& id) const {
-    return std::any_of(exercises_.begin(), exercises_.end(), [&](const ExerciseRecord& record) {
-        return record.id == id;
+// Kopien sind Entwürfe (draft()): Platz für einen weiteren Datensatz ist gleich mit angelegt,
+// damit putRecord() beim Anhängen nicht noch einmal alles umkopiert.
+StorageService::Library::Library(const Library& other) : generation_(other.generation_) {
+    records_.reserve(other.records_.size() + kIdBytes + kMaxIndexFieldsBytes);
+    records_.assign(other.records_.begin(), other.records_.end());
+    slots_.reserve(other.slots_.size() + 1);
+    slots_.assign(other.slots_.begin(), other.slots_.end());
+    index_.reserve(other.index_.size() + 1);
+    index_.assign(other.index_.begin(), other.index_.end());
+}
+
+StorageService::LibraryRef::LibraryRef(const LibraryRef& other) : library_(other.library_) {
+    if (library_) {
+        library_->refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+StorageService::LibraryRef::LibraryRef(LibraryRef&& other) noexcept : library_(other.library_) {
+    other.library_ = nullptr;
+}
+
+StorageService::LibraryRef& StorageService::LibraryRef::operator=(LibraryRef other) noexcept {
+    std::swap(library_, other.library_);
+    return *this;
+}
+
+StorageService::LibraryRef::~LibraryRef() {
+    if (library_) {
+        // freigegeben wird nur im schreibenden Task (reclaim), nie hier
+        library_->refs_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+// Lock-frei: drei atomare Operationen, keine Sperre und kein Heap.
+StorageService::LibraryRef StorageService::library() const {
+    acquiring_.fetch_add(1);
+    const Library* library = current_.load();
+    library->refs_.fetch_add(1, std::memory_order_relaxed);
+    acquiring_.fetch_sub(1);
+    return LibraryRef(library);
+}
+
+const StorageService::Library& StorageService::latest() const {
+    return draft_ ? *draft_ : *current_.load();
+}
+
+// Kopie des veröffentlichten Stands, an der sich mehrere Änderungen sammeln lassen (Laden,
+// Journal), bis publish() sie auf einmal sichtbar macht.
+StorageService::Library& StorageService::draft() {
+    if (!draft_) {
+        draft_ = new Library(*current_.load());
+    }
+    return *draft_;
+}
+
+void StorageService::publish() {
+    if (!draft_) {
+        return;
+    }
+    retired_.push_back(current_.exchange(draft_));
+    draft_ = nullptr;
+    reclaim();
+}
+
+// Gibt ersetzte Stände frei, die kein Leser mehr hält. Erst wenn gerade kein Leser zwischen
+// current_.load() und dem Hochzählen steht, ist refs_ == 0 endgültig.
+void StorageService::reclaim() {
+    if (retired_.empty()) {
+        return;
+    }
+    while (acquiring_.load() != 0) {
+        vTaskDelay(1);
+    }
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(), [](const Library* library) {
+        if (library->refs_.load(std::memory_order_acquire) != 0) {
+            return false;
+        }
+        delete library;
+        return true;
+    }), retired_.end());
+}
+
+size_t StorageService::Library::slotOf(const ExerciseId& id) const {
+    auto it = std::lower_bound(index_.begin(), index_.end(), id, [](const IndexEntry& entry, const ExerciseId& key) {
+        return entry.id < key;
     });
+    return it != index_.end() && it->id == id ? it->slot : kNotFound;
+}
+
+void StorageService::Library::rebuildIndex() {
+    index_.clear();
+    index_.reserve(slots_.size());
+    for (size_t slot = 0; slot < slots_.size(); ++slot) {
+        index_.push_back({idAt(slot), static_cast<uint16_t>(slot)});
+    }
+    std::sort(index_.begin(), index_.end(), [](const IndexEntry& a, const IndexEntry& b) {
+        return a.id < b.id;
+    });
+    ++generation_;
 }
 
 bool StorageService::validateExercise(const Exercise& exercise) const {
+    // mit MODEL_FIXED_CAPACITY ist Überlanges schon beim Befüllen gekürzt, die Prüfungen unten sähen es nicht
+    if (exercise.truncated()) {
+        Serial.println("[Storage] Exercise exceeds the model capacity.");
+        return false;
+    }
     if (exercise.sets.size() > kMaxSets) {
         Serial.println("[Storage] Too many sets for exercise.");
         return false;
@@ -121,243 +260,824 @@ bool StorageService::addExercise(const Exercise& exercise, ExerciseId* outId) {
     if (!validateExercise(exercise)) {
         return false;
     }
+    std::vector<uint8_t> body;
+    ExerciseView::encode(body, exercise);
+    return addBody(std::move(body), outId);
+}
 
-    ExerciseRecord record{};
-    record.exercise = exercise;
-    record.id = generateId();
-    while (idExists(record.id)) {
-        record.id = generateId();
+bool StorageService::updateExercise(const ExerciseId& id, const Exercise& exercise) {
+    if (latest().slotOf(id) == kNotFound) {
+        return false;
     }
+    if (!validateExercise(exercise)) {
+        return false;
+    }
+    std::vector<uint8_t> body;
+    ExerciseView::encode(body, exercise);
+    return updateBody(id, std::move(body));
+}
 
-    exercises_.push_back(record);
-    if (outId) {
-        *outId = record.id;
+bool StorageService::addExercise(const ExerciseView& exercise, ExerciseId* outId) {
+    const size_t length = measureExercise(exercise.data(), exercise.length());
+    if (length == 0) {
+        Serial.println("[Storage] Exercise damaged or exceeds limits.");
+        return false;
     }
-    return true;
+    return addBody(std::vector<uint8_t>(exercise.data(), exercise.data() + length), outId);
 }
 
-bool StorageService::updateExercise(const ExerciseId& id, const Exercise& exercise) {
-    auto it = std::find_if(exercises_.begin(), exercises_.end(), [&](const ExerciseRecord& record) {
-        return record.id == id;
-    });
-    if (it == exercises_.end()) {
+bool StorageService::updateExercise(const ExerciseId& id, const ExerciseView& exercise) {
+    if (latest().slotOf(id) == kNotFound) {
         return false;
     }
-    if (!validateExercise(exercise)) {
+    const size_t length = measureExercise(exercise.data(), exercise.length());
+    if (length == 0) {
+        Serial.println("[Storage] Exercise damaged or exceeds limits.");
         return false;
     }
-    it->exercise = exercise;
+    return updateBody(id, std::vector<uint8_t>(exercise.data(), exercise.data() + length));
+}
+
+bool StorageService::addBody(std::vector<uint8_t>&& body, ExerciseId* outId) {
+    ExerciseId id = generateId();
+    while (latest().slotOf(id) != kNotFound) {
+        id = generateId();
+    }
+
+    if (outId) {
+        *outId = id;
+    }
+    noteChange(JournalOp::PUT, id);
+    putBody(id, std::move(body));
+    publish();
+    return true;
+}
+
+bool StorageService::updateBody(const ExerciseId& id, std::vector<uint8_t>&& body) {
+    // Datensatz bleibt im selben Slot, Handles behalten ihre Gültigkeit
+    putBody(id, std::move(body));
+    noteChange(JournalOp::PUT, id);
+    publish();
     return true;
 }
 
 bool StorageService::removeExercise(const ExerciseId& id) {
-    auto it = std::find_if(exercises_.begin(), exercises_.end(), [&](const ExerciseRecord& record) {
-        return record.id == id;
-    });
-    if (it == exercises_.end()) {
+    const size_t slot = latest().slotOf(id);
+    if (slot == kNotFound) {
         return false;
     }
-    exercises_.erase(it);
+    // vor dem Löschen vermerken: id kann auf den Datensatz selbst verweisen
+    noteChange(JournalOp::REMOVE, id);
+    releaseBody(latest().bodyKeyAt(slot));
+    draft().eraseSlot(slot);
+    publish();
     return true;
 }
 
 void StorageService::clear() {
-    exercises_.clear();
+    const Library& library = latest();
+    for (size_t slot = 0; slot < library.size(); ++slot) {
+        releaseBody(library.bodyKeyAt(slot));
+    }
+    Library& next = draft();
+    next.records_.clear();
+    next.slots_.clear();
+    next.rebuildIndex();
+    publish();
+    // Lässt sich nicht sinnvoll journalisieren, beim nächsten Speichern wird kompaktiert
+    pending_.clear();
+    snapshotPending_ = true;
 }
 
-Exercise* StorageService::findExercise(const ExerciseId& id) {
-    auto it = std::find_if(exercises_.begin(), exercises_.end(), [&](const ExerciseRecord& record) {
-        return record.id == id;
-    });
-    return it != exercises_.end() ? &it->exercise : nullptr;
+void StorageService::putExercise(const ExerciseId& id, const Exercise& exercise) {
+    std::vector<uint8_t> body;
+    ExerciseView::encode(body, exercise);
+    putBody(id, std::move(body));
 }
 
-const Exercise* StorageService::findExercise(const ExerciseId& id) const {
-    auto it = std::find_if(exercises_.begin(), exercises_.end(), [&](const ExerciseRecord& record) {
-        return record.id == id;
-    });
-    return it != exercises_.end() ? &it->exercise : nullptr;
+// Legt den Körper unter einem neuen Schlüssel in den Cache und trägt die Eckdaten in den Entwurf
+// ein. Der Körper bleibt im Cache, bis savePersistent() ihn geschrieben hat.
+void StorageService::putBody(const ExerciseId& id, std::vector<uint8_t>&& body) {
+    auto bytes = std::make_shared<const std::vector<uint8_t>>(std::move(body));
+    const ExerciseView exercise(bytes->data(), bytes->size());
+    const uint16_t key = allocateBodyKey();
+    const uint32_t durationMs = ExerciseTimeline::durationMs(exercise);
+
+    std::vector<uint8_t> fields;
+    fields.reserve(kMaxIndexFieldsBytes);
+    varint::append(fields, key);
+    varint::appendText(fields, exercise.name().data, exercise.name().size);
+    varint::append(fields, static_cast<uint32_t>(exercise.setCount()));
+    varint::append(fields, durationMs / 1000 + (durationMs % 1000 != 0 ? 1 : 0));
+
+    // erst nach allocateBodyKey(): der alte Schlüssel gilt im NVS noch, bis der Index gespeichert ist
+    const size_t slot = latest().slotOf(id);
+    if (slot != kNotFound) {
+        releaseBody(latest().bodyKeyAt(slot));
+    }
+    // vor dem Index: wer den neuen Stand sieht, findet den Körper schon im Cache
+    lockBodies();
+    bodies_.push_back({key, true, false, ++bodyClock_, std::move(bytes)});
+    unlockBodies();
+    draft().putRecord(id, fields.data(), fields.size());
 }
 
-StorageService::ExerciseRecord* StorageService::findRecord(const ExerciseId& id) {
-    auto it = std::find_if(exercises_.begin(), exercises_.end(), [&](const ExerciseRecord& record) {
-        return record.id == id;
-    });
-    return it != exercises_.end() ? &(*it) : nullptr;
+// Ersetzt den Index-Datensatz mit dieser Id an Ort und Stelle oder hängt ihn hinten an.
+// Die Slots liegen in records_ in aufsteigender Reihenfolge, spätere rücken nur um die
+// Längendifferenz.
+void StorageService::Library::putRecord(const ExerciseId& id, const uint8_t* record, size_t length) {
+    const size_t slot = slotOf(id);
+    if (slot == kNotFound) {
+        const RecordSlot entry{static_cast<uint32_t>(records_.size()), static_cast<uint32_t>(kIdBytes + length)};
+        records_.insert(records_.end(), id.begin(), id.end());
+        records_.insert(records_.end(), record, record + length);
+        slots_.push_back(entry);
+
+        const IndexEntry indexEntry{id, static_cast<uint16_t>(slots_.size() - 1)};
+        index_.insert(std::upper_bound(index_.begin(), index_.end(), indexEntry,
+                                       [](const IndexEntry& a, const IndexEntry& b) { return a.id < b.id; }),
+                      indexEntry);
+        ++generation_;
+        return;
+    }
+
+    RecordSlot& entry = slots_[slot];
+    const size_t oldLength = entry.length - kIdBytes;
+    auto begin = records_.begin() + entry.offset + kIdBytes;
+    if (length == oldLength) {
+        std::copy(record, record + length, begin);
+        return;
+    }
+    begin = records_.erase(begin, begin + oldLength);
+    records_.insert(begin, record, record + length);
+    entry.length = static_cast<uint32_t>(kIdBytes + length);
+    for (size_t later = slot + 1; later < slots_.size(); ++later) {
+        slots_[later].offset = static_cast<uint32_t>(slots_[later].offset + length - oldLength);
+    }
 }
 
-const StorageService::ExerciseRecord* StorageService::findRecord(const ExerciseId& id) const {
-    auto it = std::find_if(exercises_.begin(), exercises_.end(), [&](const ExerciseRecord& record) {
-        return record.id == id;
-    });
-    return it != exercises_.end() ? &(*it) : nullptr;
+void StorageService::Library::eraseSlot(size_t slot) {
+    const RecordSlot erased = slots_[slot];
+    records_.erase(records_.begin() + erased.offset, records_.begin() + erased.offset + erased.length);
+    slots_.erase(slots_.begin() + slot);
+    for (size_t later = slot; later < slots_.size(); ++later) {
+        slots_[later].offset -= erased.length;
+    }
+    // Reihenfolge der Übungen bleibt erhalten, alle späteren Slots rücken eins auf
+    index_.erase(std::remove_if(index_.begin(), index_.end(), [&](const IndexEntry& entry) {
+        return entry.slot == slot;
+    }), index_.end());
+    for (auto& entry : index_) {
+        if (entry.slot > slot) {
+            --entry.slot;
+        }
+    }
+    ++generation_;
 }
 
-bool StorageService::serialize(std::vector<uint8_t>& buffer) const {
-    buffer.clear();
-    buffer.reserve(256);
+// Merkt sich, welche Übung beim nächsten savePersistent() ins Journal muss; mehrere
+// Änderungen an derselben Übung ergeben nur einen Eintrag mit dem letzten Stand.
+void StorageService::noteChange(JournalOp op, const ExerciseId& id) {
+    for (auto& change : pending_) {
+        if (change.id == id) {
+            change.op = op;
+            return;
+        }
+    }
+    pending_.push_back({op, id});
+}
 
-    appendUint16(buffer, kStorageVersion);
-    appendUint16(buffer, static_cast<uint16_t>(exercises_.size()));
+StorageService::ExerciseId StorageService::Library::idAt(size_t slot) const {
+    ExerciseId id{};
+    if (slot < slots_.size()) {
+        std::memcpy(id.data(), records_.data() + slots_[slot].offset, kIdBytes);
+    }
+    return id;
+}
 
-    for (const auto& record : exercises_) {
-        buffer.insert(buffer.end(), record.id.begin(), record.id.end());
+uint16_t StorageService::Library::bodyKeyAt(size_t slot) const {
+    uint32_t key = 0;
+    size_t offset = slots_[slot].offset + kIdBytes;
+    varint::read(records_.data(), records_.size(), offset, key); // von measureRecord() geprüft
+    return static_cast<uint16_t>(key);
+}
 
-        const std::string& name = record.exercise.name;
-        appendUint16(buffer, static_cast<uint16_t>(name.size()));
-        buffer.insert(buffer.end(), name.begin(), name.end());
+ExerciseSummary StorageService::Library::summaryAt(size_t slot) const {
+    ExerciseSummary summary;
+    if (slot < slots_.size()) {
+        const RecordSlot& entry = slots_[slot];
+        uint32_t key = 0;
+        readIndexFields(records_.data() + entry.offset + kIdBytes, entry.length - kIdBytes, key, summary);
+    }
+    return summary;
+}
 
-        appendUint16(buffer, static_cast<uint16_t>(record.exercise.sets.size()));
-        for (const auto& set : record.exercise.sets) {
-            appendUint16(buffer, static_cast<uint16_t>(set.label.size()));
-            buffer.insert(buffer.end(), set.label.begin(), set.label.end());
+ExerciseSummary StorageService::Library::summaryOf(const ExerciseId& id) const {
+    const size_t slot = slotOf(id);
+    return slot != kNotFound ? summaryAt(slot) : ExerciseSummary{};
+}
 
-            appendUint32(buffer, static_cast<uint32_t>(set.timePauseAfter));
-            appendUint32(buffer, static_cast<uint32_t>(set.percentMaxIntensity));
+// Kleinster Schlüssel, den weder der Index noch ein noch nicht gelöschter alter Körper belegt.
+uint16_t StorageService::allocateBodyKey() const {
+    const Library& library = latest();
+    std::vector<bool> used(library.size() + released_.size() + 1, false);
+    for (size_t slot = 0; slot < library.size(); ++slot) {
+        const uint16_t key = library.bodyKeyAt(slot);
+        if (key < used.size()) {
+            used[key] = true;
+        }
+    }
+    for (const ReleasedBody& released : released_) {
+        if (released.key < used.size()) {
+            used[released.key] = true;
+        }
+    }
+    return static_cast<uint16_t>(std::find(used.begin(), used.end(), false) - used.begin());
+}
+
+// Ein älterer Stand kann noch auf den Körper zeigen: der Schlüssel bleibt belegt und der Körper
+// erreichbar (im NVS bzw., falls nie gespeichert, im Cache), bis savePersistent() keinen älteren
+// Stand mehr findet.
+void StorageService::releaseBody(uint16_t key) {
+    lockBodies();
+    auto it = std::find_if(bodies_.begin(), bodies_.end(), [key](const CachedBody& body) { return body.key == key; });
+    bool stored = true;
+    if (it != bodies_.end()) {
+        if (it->dirty) {
+            // nie gespeichert: nicht mehr schreiben, aber für ältere Stände im Cache lassen
+            stored = false;
+            it->dirty = false;
+            it->released = true;
+        } else {
+            bodies_.erase(it);
+        }
+    }
+    unlockBodies();
+    released_.push_back({key, stored});
+}
+
+void StorageService::lockBodies() const {
+    xSemaphoreTake(bodyMutex_, portMAX_DELAY);
+}
+
+void StorageService::unlockBodies() const {
+    xSemaphoreGive(bodyMutex_);
+}
+
+// Körper aus dem Cache oder, bei einem Fehlzugriff, aus dem NVS. Der Mutex bleibt auch während
+// des Ladens gehalten, damit zwei Leser denselben Körper nicht doppelt laden.
+std::shared_ptr<const std::vector<uint8_t>> StorageService::body(uint16_t key) {
+    lockBodies();
+    std::shared_ptr<const std::vector<uint8_t>> bytes = findBodyLocked(key);
+    if (!bytes) {
+        bytes = loadBody(key);
+    }
+    unlockBodies();
+    return bytes;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> StorageService::cachedBody(uint16_t key) {
+    lockBodies();
+    std::shared_ptr<const std::vector<uint8_t>> bytes = findBodyLocked(key);
+    unlockBodies();
+    return bytes;
+}
+
+// Nur mit gehaltenem Cache-Mutex aufrufen.
+std::shared_ptr<const std::vector<uint8_t>> StorageService::findBodyLocked(uint16_t key) {
+    for (auto& body : bodies_) {
+        if (body.key == key) {
+            body.lastUse = ++bodyClock_;
+            ++cacheStats_.hits;
+            return body.bytes;
+        }
+    }
+    return nullptr;
+}
 
-            appendUint16(buffer, static_cast<uint16_t>(set.reps.size()));
-            for (const auto& rep : set.reps) {
-                appendUint32(buffer, static_cast<uint32_t>(rep.timeRep));
-                appendUint32(buffer, static_cast<uint32_t>(rep.timeRest));
+// Verdrängt die am längsten nicht benutzten gespeicherten Körper; ungespeicherte und ersetzte bleiben.
+// Nur mit gehaltenem Cache-Mutex aufrufen.
+void StorageService::trimBodyCache() {
+    for (;;) {
+        auto oldest = bodies_.end();
+        size_t clean = 0;
+        for (auto it = bodies_.begin(); it != bodies_.end(); ++it) {
+            if (it->dirty || it->released) {
+                continue;
             }
+            ++clean;
+            if (oldest == bodies_.end() || it->lastUse < oldest->lastUse) {
+                oldest = it;
+            }
+        }
+        if (clean <= kBodyCacheSize) {
+            return;
         }
+        bodies_.erase(oldest);
+        ++cacheStats_.evictions;
+    }
+}
+
+StorageService::CacheStats StorageService::cacheStats() const {
+    lockBodies();
+    const CacheStats stats = cacheStats_;
+    unlockBodies();
+    return stats;
+}
+
+StorageService::ExerciseRef StorageService::exerciseAt(const Library& library, size_t slot) {
+    ExerciseRef exercise;
+    if (slot < library.size()) {
+        exercise.body_ = body(library.bodyKeyAt(slot));
+        if (exercise.body_) {
+            exercise.view_ = ExerciseView(exercise.body_->data(), exercise.body_->size());
+        }
+    }
+    return exercise;
+}
+
+StorageService::ExerciseRef StorageService::find(const ExerciseId& id) {
+    const LibraryRef current = library();
+    const size_t slot = current->slotOf(id);
+    return slot != kNotFound ? exerciseAt(*current, slot) : ExerciseRef{};
+}
+
+StorageService::ExerciseHandle StorageService::Library::handleFor(const ExerciseId& id) const {
+    ExerciseHandle handle;
+    handle.id = id;
+    resolveSlot(handle);
+    return handle;
+}
+
+bool StorageService::Library::resolveSlot(ExerciseHandle& handle) const {
+    if (handle.generation == 0 || handle.generation != generation_) {
+        const size_t slot = slotOf(handle.id);
+        if (slot == kNotFound) {
+            handle.generation = 0;
+            return false;
+        }
+        handle.slot = static_cast<uint32_t>(slot);
+        handle.generation = generation_;
     }
     return true;
 }
 
-bool StorageService::deserialize(const uint8_t* data, size_t length) {
-    exercises_.clear();
-    if (length == 0) {
-        return true;
+StorageService::ExerciseRef StorageService::resolve(ExerciseHandle& handle) {
+    const LibraryRef current = library();
+    return current->resolveSlot(handle) ? exerciseAt(*current, handle.slot) : ExerciseRef{};
+}
+
+StorageService::ExerciseRef StorageService::resolveCached(ExerciseHandle& handle) {
+    const LibraryRef current = library();
+    ExerciseRef exercise;
+    if (current->resolveSlot(handle)) {
+        exercise.body_ = cachedBody(current->bodyKeyAt(handle.slot));
+        if (exercise.body_) {
+            exercise.view_ = ExerciseView(exercise.body_->data(), exercise.body_->size());
+        }
     }
+    return exercise;
+}
 
-    size_t offset = 0;
-    uint16_t version = 0;
-    if (!readUint16(data, length, offset, version)) {
-        return false;
+ExerciseSummary StorageService::Library::resolveSummary(ExerciseHandle& handle) const {
+    return resolveSlot(handle) ? summaryAt(handle.slot) : ExerciseSummary{};
+}
+
+size_t StorageService::measureRecord(const uint8_t* data, size_t length) {
+    uint32_t key = 0;
+    ExerciseSummary summary;
+    if (length < kIdBytes) {
+        return 0;
     }
-    if (version != kStorageVersion) {
-        Serial.println("[Storage] Incompatible storage version.");
-        return false;
+    const size_t fields = readIndexFields(data + kIdBytes, length - kIdBytes, key, summary);
+    if (fields == 0 || key > UINT16_MAX || summary.name.size > kMaxExerciseNameLength ||
+        summary.setCount > kMaxSets) {
+        return 0;
     }
+    return kIdBytes + fields;
+}
+
+size_t StorageService::measureExercise(const uint8_t* data, size_t length) {
+    return ExerciseView::measure(data, length, kMaxSets, kMaxRepsPerSet, kMaxExerciseNameLength,
+                                 kMaxSetLabelLength);
+}
 
-    uint16_t count = 0;
-    if (!readUint16(data, length, offset, count)) {
+bool StorageService::readRecordV1(const uint8_t* data, size_t length, size_t& offset, LegacyRecord& record) {
+    if (!readBytes(data, length, offset, record.id.data(), record.id.size())) {
         return false;
     }
 
-    exercises_.reserve(count);
-
-    for (uint16_t recordIndex = 0; recordIndex < count; ++recordIndex) {
-        ExerciseRecord record{};
-        if (!readBytes(data, length, offset, record.id.data(), record.id.size())) {
+    uint16_t nameLength = 0;
+    if (!readUint16(data, length, offset, nameLength)) {
+        return false;
+    }
+    if (nameLength > kMaxExerciseNameLength) {
+        return false;
+    }
+    record.exercise.name.clear();
+    if (nameLength > 0) {
+        record.exercise.name.resize(nameLength);
+        if (!readBytes(data, length, offset, reinterpret_cast<uint8_t*>(&record.exercise.name[0]), nameLength)) {
             return false;
         }
+    }
 
-        uint16_t nameLength = 0;
-        if (!readUint16(data, length, offset, nameLength)) {
+    uint16_t setCount = 0;
+    if (!readUint16(data, length, offset, setCount)) {
+        return false;
+    }
+    if (setCount > kMaxSets) {
+        return false;
+    }
+    record.exercise.sets.clear();
+    record.exercise.sets.reserve(setCount);
+
+    for (uint16_t setIndex = 0; setIndex < setCount; ++setIndex) {
+        Set set;
+
+        uint16_t labelLength = 0;
+        if (!readUint16(data, length, offset, labelLength)) {
             return false;
         }
-        if (nameLength > kMaxExerciseNameLength) {
+        if (labelLength > kMaxSetLabelLength) {
             return false;
         }
-        record.exercise.name.clear();
-        if (nameLength > 0) {
-            record.exercise.name.resize(nameLength);
-            if (!readBytes(data, length, offset, reinterpret_cast<uint8_t*>(&record.exercise.name[0]), nameLength)) {
+        set.label.clear();
+        if (labelLength > 0) {
+            set.label.resize(labelLength);
+            if (!readBytes(data, length, offset, reinterpret_cast<uint8_t*>(&set.label[0]), labelLength)) {
                 return false;
             }
         }
 
-        uint16_t setCount = 0;
-        if (!readUint16(data, length, offset, setCount)) {
+        uint32_t pauseAfter = 0;
+        if (!readUint32(data, length, offset, pauseAfter)) {
             return false;
         }
-        if (setCount > kMaxSets) {
+        set.timePauseAfter = static_cast<int>(pauseAfter);
+
+        uint32_t percent = 0;
+        if (!readUint32(data, length, offset, percent)) {
             return false;
         }
-        record.exercise.sets.reserve(setCount);
+        set.percentMaxIntensity = static_cast<int>(percent);
 
-        for (uint16_t setIndex = 0; setIndex < setCount; ++setIndex) {
-            Set set;
+        uint16_t repCount = 0;
+        if (!readUint16(data, length, offset, repCount)) {
+            return false;
+        }
+        if (repCount > kMaxRepsPerSet) {
+            return false;
+        }
+        set.reps.reserve(repCount);
 
-            uint16_t labelLength = 0;
-            if (!readUint16(data, length, offset, labelLength)) {
+        for (uint16_t repIndex = 0; repIndex < repCount; ++repIndex) {
+            uint32_t repTime = 0;
+            uint32_t restTime = 0;
+            if (!readUint32(data, length, offset, repTime) ||
+                !readUint32(data, length, offset, restTime)) {
                 return false;
             }
-            if (labelLength > kMaxSetLabelLength) {
-                return false;
-            }
-            set.label.clear();
-            if (labelLength > 0) {
-                set.label.resize(labelLength);
-                if (!readBytes(data, length, offset, reinterpret_cast<uint8_t*>(&set.label[0]), labelLength)) {
-                    return false;
-                }
-            }
+            set.reps.emplace_back(static_cast<int>(repTime), static_cast<int>(restTime));
+        }
 
-            uint32_t pauseAfter = 0;
-            if (!readUint32(data, length, offset, pauseAfter)) {
-                return false;
-            }
-            set.timePauseAfter = static_cast<int>(pauseAfter);
+        record.exercise.sets.push_back(std::move(set));
+    }
+    return !record.exercise.truncated();
+}
+
+bool StorageService::serialize(std::vector<uint8_t>& buffer, const Library& library) const {
+    buffer.clear();
+    buffer.reserve(library.records_.size() + 16);
+
+    appendUint16(buffer, kStorageVersion);
+    varint::append(buffer, static_cast<uint32_t>(library.size()));
+    // records_ liegt bereits im Snapshot-Format vor
+    buffer.insert(buffer.end(), library.records_.begin(), library.records_.end());
+    // Epoche, zu der die Journal-Einträge gehören
+    varint::append(buffer, journalEpoch_);
+    return true;
+}
+
+// Übernimmt den gelesenen Index als records_: die Datensätze werden nur geprüft und vermessen,
+// Kopf und Epoche abgeschnitten. Ältere Snapshots mit ganzen Übungen werden einmalig aufgeteilt.
+bool StorageService::deserialize(std::vector<uint8_t>&& buffer) {
+    // neuer Entwurf; die Generation steigt weiter, damit kein alter Handle zufällig passt
+    const uint32_t generation = latest().generation_ + 1;
+    delete draft_;
+    draft_ = new Library();
+    draft_->generation_ = generation;
+    Library& next = *draft_;
+    lockBodies();
+    bodies_.clear();
+    unlockBodies();
+    released_.clear();
+    journalEpoch_ = 0;
+    storedVersion_ = kStorageVersion;
+    if (buffer.empty()) {
+        return true;
+    }
+
+    const uint8_t* data = buffer.data();
+    const size_t length = buffer.size();
+    size_t offset = 0;
+    uint16_t version = 0;
+    if (!readUint16(data, length, offset, version)) {
+        return false;
+    }
+    if (version != kStorageVersion && version != kInlineStorageVersion && version != kLegacyStorageVersion) {
+        Serial.println("[Storage] Incompatible storage version.");
+        return false;
+    }
+    storedVersion_ = version;
+
+    uint32_t count = 0;
+    if (version == kLegacyStorageVersion) {
+        uint16_t legacyCount = 0;
+        if (!readUint16(data, length, offset, legacyCount)) {
+            return false;
+        }
+        count = legacyCount;
+    } else if (!varint::read(data, length, offset, count)) {
+        return false;
+    }
+
+    // Jeder Datensatz belegt mindestens seine 16-Byte-Id; schützt vor unsinnigen Zählern
+    next.slots_.reserve(std::min<size_t>(count, length / kIdBytes));
 
-            uint32_t percent = 0;
-            if (!readUint32(data, length, offset, percent)) {
+    const size_t recordsBegin = offset;
+    for (uint32_t recordIndex = 0; recordIndex < count; ++recordIndex) {
+        if (version == kLegacyStorageVersion) {
+            LegacyRecord record{};
+            if (!readRecordV1(data, length, offset, record)) {
                 return false;
             }
-            set.percentMaxIntensity = static_cast<int>(percent);
-
-            uint16_t repCount = 0;
-            if (!readUint16(data, length, offset, repCount)) {
+            putExercise(record.id, record.exercise);
+            continue;
+        }
+        if (version == kInlineStorageVersion) {
+            ExerciseId id{};
+            if (!readBytes(data, length, offset, id.data(), id.size())) {
                 return false;
             }
-            if (repCount > kMaxRepsPerSet) {
+            const size_t bodyLength = measureExercise(data + offset, length - offset);
+            if (bodyLength == 0) {
                 return false;
             }
-            set.reps.reserve(repCount);
-
-            for (uint16_t repIndex = 0; repIndex < repCount; ++repIndex) {
-                uint32_t repTime = 0;
-                uint32_t restTime = 0;
-                if (!readUint32(data, length, offset, repTime) ||
-                    !readUint32(data, length, offset, restTime)) {
-                    return false;
+            putBody(id, std::vector<uint8_t>(data + offset, data + offset + bodyLength));
+            offset += bodyLength;
+            continue;
+        }
+        const size_t recordLength = measureRecord(data + offset, length - offset);
+        if (recordLength == 0) {
+            return false;
+        }
+        next.slots_.push_back({static_cast<uint32_t>(offset - recordsBegin), static_cast<uint32_t>(recordLength)});
+        offset += recordLength;
+    }
+    const size_t recordsEnd = offset;
+
+    // v1-Snapshots ohne Anhang stammen aus der Zeit vor dem Journal
+    uint32_t epoch = 0;
+    const bool hasEpoch = version == kLegacyStorageVersion ? readUint32(data, length, offset, epoch)
+                                                           : varint::read(data, length, offset, epoch);
+    if (hasEpoch) {
+        journalEpoch_ = epoch;
+    }
+
+    if (version == kStorageVersion) {
+        buffer.erase(buffer.begin() + recordsEnd, buffer.end());
+        buffer.erase(buffer.begin(), buffer.begin() + recordsBegin);
+        next.records_.swap(buffer);
+    }
+    return true;
+}
+
+#ifdef STORAGE_HAS_PREFERENCES
+namespace {
+void journalKey(char (&key)[kNvsKeySize], size_t index) {
+    std::snprintf(key, sizeof(key), "%s%u", kJournalKeyPrefix, static_cast<unsigned>(index));
+}
+
+void bodyKey(char (&key)[kNvsKeySize], uint16_t index) {
+    std::snprintf(key, sizeof(key), "%s%u", kBodyKeyPrefix, static_cast<unsigned>(index));
+}
+} // namespace
+
+// Spielt die Journal-Einträge j0, j1, ... der aktuellen Epoche auf den geladenen Snapshot.
+// Der erste fehlende, beschädigte oder veraltete Eintrag (aus der Zeit vor der letzten
+// Kompaktierung) beendet das Journal; der nächste Eintrag überschreibt ihn.
+void StorageService::replayJournal(Preferences& prefs) {
+    journalRecords_ = 0;
+    journalBytes_ = 0;
+    std::vector<uint8_t> buffer;
+    for (size_t index = 0; index < kJournalMaxRecords; ++index) {
+        char key[kNvsKeySize];
+        journalKey(key, index);
+        const size_t length = prefs.isKey(key) ? prefs.getBytesLength(key) : 0;
+        if (length == 0) {
+            break;
+        }
+        buffer.resize(length);
+        prefs.getBytes(key, buffer.data(), length);
+
+        size_t offset = 0;
+        uint32_t epoch = 0;
+        uint8_t op = 0;
+        if (!readUint32(buffer.data(), length, offset, epoch) || epoch != journalEpoch_ ||
+            !readBytes(buffer.data(), length, offset, &op, 1)) {
+            break;
+        }
+
+        ExerciseId id{};
+        if (!readBytes(buffer.data(), length, offset, id.data(), id.size())) {
+            break;
+        }
+        if (op == static_cast<uint8_t>(JournalOp::PUT)) {
+            // Journal-Einträge sind im Format ihres Snapshots geschrieben
+            if (storedVersion_ == kLegacyStorageVersion) {
+                LegacyRecord record{};
+                offset -= id.size();
+                if (!readRecordV1(buffer.data(), length, offset, record)) {
+                    break;
+                }
+                putExercise(record.id, record.exercise);
+            } else if (storedVersion_ == kInlineStorageVersion) {
+                const size_t bodyLength = measureExercise(buffer.data() + offset, length - offset);
+                if (bodyLength == 0) {
+                    break;
                 }
-                set.reps.emplace_back(static_cast<int>(repTime), static_cast<int>(restTime));
+                putBody(id, std::vector<uint8_t>(buffer.begin() + offset, buffer.begin() + offset + bodyLength));
+            } else {
+                // Index-Eintrag; der Körper steht bereits unter seinem Schlüssel
+                const size_t recordStart = offset - id.size();
+                const size_t recordLength = measureRecord(buffer.data() + recordStart, length - recordStart);
+                if (recordLength == 0) {
+                    break;
+                }
+                draft().putRecord(id, buffer.data() + offset, recordLength - id.size());
+            }
+        } else if (op == static_cast<uint8_t>(JournalOp::REMOVE)) {
+            const size_t slot = latest().slotOf(id);
+            if (slot != kNotFound) {
+                draft().eraseSlot(slot);
             }
+        } else {
+            break;
+        }
+        ++journalRecords_;
+        journalBytes_ += length;
+    }
+}
 
-            record.exercise.sets.push_back(std::move(set));
+bool StorageService::appendJournal(Preferences& prefs, const SaveBatch& batch) {
+    const Library& library = *batch.library_;
+    std::vector<uint8_t> buffer;
+    for (const auto& change : batch.changes_) {
+        const size_t slot = library.slotOf(change.id);
+        const bool put = change.op == JournalOp::PUT && slot != kNotFound;
+        buffer.clear();
+        appendUint32(buffer, journalEpoch_);
+        buffer.push_back(static_cast<uint8_t>(put ? JournalOp::PUT : JournalOp::REMOVE));
+        if (put) {
+            const Library::RecordSlot& entry = library.slots_[slot];
+            buffer.insert(buffer.end(), library.records_.begin() + entry.offset,
+                          library.records_.begin() + entry.offset + entry.length);
+        } else {
+            buffer.insert(buffer.end(), change.id.begin(), change.id.end());
         }
 
-        exercises_.push_back(std::move(record));
+        char key[kNvsKeySize];
+        journalKey(key, journalRecords_);
+        if (prefs.putBytes(key, buffer.data(), buffer.size()) != buffer.size()) {
+            return false;
+        }
+        ++journalRecords_;
+        journalBytes_ += buffer.size();
     }
+    return true;
+}
 
+// Neuer Snapshot unter neuer Epoche; alte Journal-Einträge passen danach nicht mehr und
+// werden ignoriert, auch wenn das Löschen unterbrochen wird.
+bool StorageService::writeSnapshot(Preferences& prefs, const Library& library) {
+    const uint32_t previousRecords = journalRecords_;
+    ++journalEpoch_;
+    std::vector<uint8_t> buffer;
+    if (!serialize(buffer, library)) {
+        --journalEpoch_;
+        Serial.println("[Storage] Serialization failed.");
+        return false;
+    }
+    if (prefs.putBytes(kPrefsKey, buffer.data(), buffer.size()) != buffer.size()) {
+        // alter Snapshot gilt weiter, also auch seine Epoche
+        --journalEpoch_;
+        return false;
+    }
+    for (size_t index = 0; index < previousRecords; ++index) {
+        char key[kNvsKeySize];
+        journalKey(key, index);
+        prefs.remove(key);
+    }
+    journalRecords_ = 0;
+    journalBytes_ = 0;
+    storedVersion_ = kStorageVersion;
     return true;
 }
 
+// Neue Körper vor dem Index schreiben, damit dieser nie auf einen fehlenden Schlüssel zeigt.
+// Als gespeichert markiert endSave() sie erst, bis dahin bleiben sie im Cache.
+bool StorageService::writeBodies(Preferences& prefs, SaveBatch& batch) {
+    for (; batch.written_ < batch.bodies_.size(); ++batch.written_) {
+        const CachedBody& body = batch.bodies_[batch.written_];
+        char key[kNvsKeySize];
+        bodyKey(key, body.key);
+        const std::vector<uint8_t>& bytes = *body.bytes;
+        if (prefs.putBytes(key, bytes.data(), bytes.size()) != bytes.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+// Nur mit gehaltenem Cache-Mutex aufrufen.
+std::shared_ptr<const std::vector<uint8_t>> StorageService::loadBody(uint16_t key) {
+#ifdef STORAGE_HAS_PREFERENCES
+    Preferences prefs;
+    if (!prefs.begin(kPrefsNamespace, true)) {
+        return nullptr;
+    }
+    char name[kNvsKeySize];
+    bodyKey(name, key);
+    const size_t length = prefs.isKey(name) ? prefs.getBytesLength(name) : 0;
+    std::vector<uint8_t> bytes(length);
+    if (length > 0) {
+        prefs.getBytes(name, bytes.data(), length);
+    }
+    prefs.end();
+    if (length == 0 || measureExercise(bytes.data(), bytes.size()) != length) {
+        Serial.printf("[Storage] Exercise body %s missing or damaged.\n", name);
+        return nullptr;
+    }
+
+    ++cacheStats_.loads;
+    auto body = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+    bodies_.push_back({key, false, false, ++bodyClock_, body});
+    trimBodyCache();
+    return body;
+#else
+    (void)key;
+    return nullptr;
+#endif
+}
+
 bool StorageService::loadPersistent() {
-#ifdef ESP_PLATFORM
+#ifdef STORAGE_HAS_PREFERENCES
     Preferences prefs;
     if (!prefs.begin(kPrefsNamespace, true)) {
         Serial.println("[Storage] Failed to open preferences for reading.");
         return false;
     }
 
+    // Nur der Index; der gelesene Puffer wird direkt zu records_
     size_t length = prefs.getBytesLength(kPrefsKey);
     std::vector<uint8_t> buffer(length > 0 ? length : 0);
     if (length > 0) {
         prefs.getBytes(kPrefsKey, buffer.data(), length);
     }
-    prefs.end();
 
-    if (!deserialize(buffer.data(), buffer.size())) {
+    // Snapshot und Journal landen im Entwurf und werden zusammen veröffentlicht
+    bool ok = deserialize(std::move(buffer));
+    Library& next = draft();
+    if (!ok) {
+        next.records_.clear();
+        next.slots_.clear();
+        lockBodies();
+        bodies_.clear();
+        unlockBodies();
+    }
+    next.rebuildIndex();
+    if (ok) {
+        replayJournal(prefs);
+    }
+    prefs.end();
+    publish();
+    pending_.clear();
+    snapshotPending_ = false;
+    if (!ok) {
         Serial.println("[Storage] Failed to deserialize exercises.");
-        exercises_.clear();
         return false;
     }
 
-    Serial.printf("[Storage] Loaded %u exercises from NVS.\n", static_cast<unsigned>(exercises_.size()));
+    Serial.printf("[Storage] Loaded %u exercises from NVS (%u journal entries).\n",
+                  static_cast<unsigned>(latest().size()), static_cast<unsigned>(journalRecords_));
+    if (storedVersion_ != kStorageVersion) {
+        // Einmalige Migration: alter Snapshot samt Journal wird als aktuelles Format neu geschrieben
+        Serial.printf("[Storage] Migrating storage from v%u to v%u.\n", static_cast<unsigned>(storedVersion_),
+                      static_cast<unsigned>(kStorageVersion));
+        compact();
+    }
     return true;
 #else
     Serial.println("[Storage] Persistent storage not available on this platform.");
@@ -365,40 +1085,152 @@ bool StorageService::loadPersistent() {
 #endif
 }
 
-bool StorageService::savePersistent() const {
-#ifdef ESP_PLATFORM
-    std::vector<uint8_t> buffer;
-    if (!serialize(buffer)) {
-        Serial.println("[Storage] Serialization failed.");
+bool StorageService::savePersistent() {
+#ifdef STORAGE_HAS_PREFERENCES
+    SaveBatch batch;
+    if (!beginSave(batch)) {
+        return true;
+    }
+    const bool ok = writeSave(batch);
+    endSave(batch, ok);
+    removeReleased(batch);
+    return ok;
+#else
+    Serial.println("[Storage] Skipping persistence on this platform.");
+    return true;
+#endif
+}
+
+bool StorageService::beginSave(SaveBatch& batch) {
+    // Jeder neue Körper gehört zu einer Änderung in pending_
+    if (pending_.empty() && !snapshotPending_) {
         return false;
     }
+    batch.library_ = library();
+    batch.changes_.swap(pending_);
+    savingChanges_ = batch.changes_.size();
+    batch.snapshotPending_ = snapshotPending_;
+    snapshotPending_ = false;
+    // Kleine Änderungen landen als Journal-Einträge, erst ab der Schwelle wird der ganze
+    // Index neu geschrieben. Geänderte Übungskörper stehen immer unter einem neuen Schlüssel.
+    batch.compact_ = batch.snapshotPending_ || storedVersion_ != kStorageVersion ||
+                     journalRecords_ + batch.changes_.size() > kJournalMaxRecords || journalBytes_ > kJournalMaxBytes;
+    batch.released_ = released_.size();
+    lockBodies();
+    for (const auto& body : bodies_) {
+        if (body.dirty) {
+            batch.bodies_.push_back(body);
+        }
+    }
+    unlockBodies();
+    return true;
+}
 
+// Läuft ohne Schreib-Lock: liest nur den festgehaltenen Stand und den Journal-Zustand.
+bool StorageService::writeSave(SaveBatch& batch) {
+#ifdef STORAGE_HAS_PREFERENCES
     Preferences prefs;
     if (!prefs.begin(kPrefsNamespace, false)) {
         Serial.println("[Storage] Failed to open preferences for writing.");
         return false;
     }
-
-    bool ok = true;
-    if (buffer.empty()) {
-        ok = prefs.remove(kPrefsKey);
-    } else {
-        size_t written = prefs.putBytes(kPrefsKey, buffer.data(), buffer.size());
-        ok = (written == buffer.size());
-    }
+    const bool ok = writeBodies(prefs, batch) &&
+                    (batch.compact_ ? writeSnapshot(prefs, *batch.library_) : appendJournal(prefs, batch));
     prefs.end();
 
     if (!ok) {
         Serial.println("[Storage] Failed to persist exercises.");
         return false;
     }
-
-    Serial.printf("[Storage] Saved %u exercises to NVS.\n", static_cast<unsigned>(exercises_.size()));
+    Serial.printf("[Storage] Saved %u exercises to NVS (%s).\n", static_cast<unsigned>(batch.library_->size()),
+                  batch.compact_ ? "snapshot" : "journal");
     return true;
 #else
-    Serial.println("[Storage] Skipping persistence on this platform.");
-    return true;
+    (void)batch;
+    return false;
+#endif
+}
+
+void StorageService::endSave(SaveBatch& batch, bool ok) {
+    // Geschriebene Körper dürfen aus dem Cache verdrängt werden. Wurde einer währenddessen ersetzt,
+    // steht er trotzdem im NVS und muss dort später gelöscht werden.
+    lockBodies();
+    for (size_t index = 0; index < batch.written_; ++index) {
+        for (auto& body : bodies_) {
+            if (body.key == batch.bodies_[index].key) {
+                body.dirty = false;
+            }
+        }
+    }
+    unlockBodies();
+    for (size_t index = 0; index < batch.written_; ++index) {
+        for (auto& released : released_) {
+            if (released.key == batch.bodies_[index].key) {
+                released.stored = true;
+            }
+        }
+    }
+
+    savingChanges_ = 0;
+    batch.library_ = LibraryRef();
+    reclaim();
+    if (!ok) {
+        // nächster Versuch mit allen Änderungen; neuere Einträge in pending_ haben Vorrang
+        for (const auto& change : batch.changes_) {
+            if (std::none_of(pending_.begin(), pending_.end(),
+                             [&change](const PendingChange& newer) { return newer.id == change.id; })) {
+                pending_.push_back(change);
+            }
+        }
+        snapshotPending_ = snapshotPending_ || batch.snapshotPending_;
+        return;
+    }
+
+    if (retired_.empty()) {
+        // Weder der gespeicherte Index noch ein Leser zeigt noch auf die vor beginSave() ersetzten
+        // Körper. Geht das Löschen schief, bleibt höchstens ein verwaister Schlüssel, den eine
+        // spätere Übung überschreibt.
+        for (size_t index = 0; index < batch.released_; ++index) {
+            if (released_[index].stored) {
+                batch.obsolete_.push_back(released_[index].key);
+            }
+        }
+        released_.erase(released_.begin(), released_.begin() + batch.released_);
+        lockBodies();
+        bodies_.erase(std::remove_if(bodies_.begin(), bodies_.end(), [](const CachedBody& body) {
+            return body.released;
+        }), bodies_.end());
+        unlockBodies();
+    }
+    lockBodies();
+    trimBodyCache();
+    unlockBodies();
+}
+
+// Die Schlüssel sind schon wieder frei; ein neuer Körper darunter wird frühestens beim nächsten
+// Speichern geschrieben, also nach dem Löschen hier.
+void StorageService::removeReleased(SaveBatch& batch) {
+#ifdef STORAGE_HAS_PREFERENCES
+    if (batch.obsolete_.empty()) {
+        return;
+    }
+    Preferences prefs;
+    if (!prefs.begin(kPrefsNamespace, false)) {
+        return;
+    }
+    for (const uint16_t released : batch.obsolete_) {
+        char key[kNvsKeySize];
+        bodyKey(key, released);
+        prefs.remove(key);
+    }
+    prefs.end();
 #endif
+    batch.obsolete_.clear();
+}
+
+bool StorageService::compact() {
+    snapshotPending_ = true;
+    return savePersistent();
 }
 
 StorageService::ExerciseId StorageService::fromHex(const String& hex) {
@@ -2,50 +2,290 @@
 
 #include <Arduino.h>
 #include <array>
+#include <atomic>
+#include <freertos/semphr.h>
+#include <memory>
 #include <vector>
 #include "models/datastructures.h"
+#include "models/exerciseview.h"
+
+class Preferences;
 
 class StorageService {
 public:
     using ExerciseId = std::array<uint8_t, 16>;
 
-    static constexpr size_t kMaxSets = 15;
-    static constexpr size_t kMaxRepsPerSet = 30;
-    static constexpr size_t kMaxExerciseNameLength = 64;
-    static constexpr size_t kMaxSetLabelLength = 64;
+    static constexpr size_t kMaxSets = limits::kMaxSets;
+    static constexpr size_t kMaxRepsPerSet = limits::kMaxRepsPerSet;
+    static constexpr size_t kMaxExerciseNameLength = limits::kMaxExerciseNameLength;
+    static constexpr size_t kMaxSetLabelLength = limits::kMaxSetLabelLength;
+    // Größte Übung innerhalb dieser Grenzen (jede Rep eine eigene Gruppe)
+    static constexpr size_t kMaxBodyBytes =
+        ExerciseBuilder::capacity(kMaxSets, kMaxRepsPerSet, kMaxExerciseNameLength, kMaxSetLabelLength);
+    // Ab hier schreibt savePersistent() statt weiterer Journal-Einträge einen neuen Snapshot
+    static constexpr size_t kJournalMaxRecords = 16;
+    static constexpr size_t kJournalMaxBytes = 4096;
+    // Zuletzt benutzte Übungskörper, die nach dem Laden im RAM bleiben
+    static constexpr size_t kBodyCacheSize = 4;
 
-    struct ExerciseRecord {
-        ExerciseId id;
-        Exercise exercise;
+    // Zwischengespeicherte Auflösung einer Id. Solange sich die Anordnung der Datensätze nicht
+    // geändert hat (generation), liefert resolve() den Slot ohne Suche.
+    struct ExerciseHandle {
+        ExerciseId id{};
+        uint32_t slot = 0;
+        uint32_t generation = 0; // 0 = noch nicht aufgelöst
+    };
+
+    // Unveränderlicher Stand des Index (Id, Schlüssel des Körpers, Name, Anzahl Sets, Dauer). Jede
+    // Änderung baut einen neuen Stand und veröffentlicht ihn; Leser halten ihren Stand über eine
+    // LibraryRef fest, ohne zu sperren. Summaries zeigen in den Stand und gelten, solange er gehalten wird.
+    class Library {
+    public:
+        Library() = default;
+        Library(const Library& other);
+        Library& operator=(const Library&) = delete;
+
+        size_t size() const { return slots_.size(); }
+        ExerciseId idAt(size_t slot) const;
+        ExerciseSummary summaryAt(size_t slot) const;
+        ExerciseSummary summaryOf(const ExerciseId& id) const;
+
+        ExerciseHandle handleFor(const ExerciseId& id) const;
+        // Aktualisiert den Handle, falls Datensätze seit der letzten Auflösung verschoben wurden.
+        bool resolveSlot(ExerciseHandle& handle) const;
+        ExerciseSummary resolveSummary(ExerciseHandle& handle) const;
+
+    private:
+        friend class StorageService;
+        friend class LibraryRef;
+
+        // Nach Id sortiert, verweist auf den Slot in slots_ (binäre Suche statt linearer Id-Vergleiche)
+        struct IndexEntry {
+            ExerciseId id;
+            uint16_t slot;
+        };
+
+        // Lage eines Index-Datensatzes in records_
+        struct RecordSlot {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        size_t slotOf(const ExerciseId& id) const;
+        uint16_t bodyKeyAt(size_t slot) const;
+        void rebuildIndex();
+        void putRecord(const ExerciseId& id, const uint8_t* record, size_t length);
+        void eraseSlot(size_t slot);
+
+        // Index aller Übungen hintereinander, genau so wie im Snapshot: geladen wird ohne Umkopieren,
+        // gespeichert ohne erneutes Kodieren.
+        std::vector<uint8_t> records_;
+        std::vector<RecordSlot> slots_;
+        std::vector<IndexEntry> index_;
+        uint32_t generation_ = 1; // steigt, sobald Datensätze hinzukommen, wegfallen oder umziehen
+        mutable std::atomic<uint32_t> refs_{0};
+    };
+
+    // Hält einen Library-Stand fest, solange sie lebt. Kopieren zählt nur die Referenz hoch.
+    class LibraryRef {
+    public:
+        LibraryRef() = default;
+        LibraryRef(const LibraryRef& other);
+        LibraryRef(LibraryRef&& other) noexcept;
+        LibraryRef& operator=(LibraryRef other) noexcept;
+        ~LibraryRef();
+
+        const Library& operator*() const { return *library_; }
+        const Library* operator->() const { return library_; }
+
+    private:
+        friend class StorageService;
+        explicit LibraryRef(const Library* library) : library_(library) {} // Referenz bereits gezählt
+
+        const Library* library_ = nullptr;
+    };
+
+    // Eine Übung samt ihrem Körper. Der View bleibt gültig, solange die Referenz lebt, auch wenn
+    // die Übung inzwischen geändert, gelöscht oder aus dem Cache verdrängt wurde.
+    class ExerciseRef {
+    public:
+        ExerciseRef() = default;
+
+        const ExerciseView& view() const { return view_; }
+        const ExerciseView* operator->() const { return &view_; }
+        explicit operator bool() const { return view_.valid(); }
+
+    private:
+        friend class StorageService;
+        std::shared_ptr<const std::vector<uint8_t>> body_;
+        ExerciseView view_;
     };
 
+    // Ein Speichervorgang in Schritten, siehe beginSave()
+    class SaveBatch;
+
     StorageService();
+    ~StorageService();
+    StorageService(const StorageService&) = delete;
+    StorageService& operator=(const StorageService&) = delete;
 
+    // Änderungen, Laden und Speichern dürfen nur aus einem Task zugleich kommen (siehe
+    // PersistenceWorker::modify); lesen darf jeder Task jederzeit. Ausnahme sind writeSave() und
+    // removeReleased(), die neben Änderungen laufen dürfen.
     bool addExercise(const Exercise& exercise, ExerciseId* outId = nullptr);
     bool updateExercise(const ExerciseId& id, const Exercise& exercise);
+    // Übernimmt eine bereits kodierte Übung (z. B. aus einem ExerciseBuilder) mit einer Kopie
+    // ihrer Bytes, ohne sie erst in ein Exercise zu zerlegen.
+    bool addExercise(const ExerciseView& exercise, ExerciseId* outId = nullptr);
+    bool updateExercise(const ExerciseId& id, const ExerciseView& exercise);
     bool removeExercise(const ExerciseId& id);
     void clear();
 
+    // Lädt beim Start nur den Index (Id, Name, Anzahl Sets, Dauer) und spielt das Journal darauf ab.
+    // Sets und Reps liegen je Übung unter einem eigenen Schlüssel und werden erst bei Bedarf gelesen.
     bool loadPersistent();
-    bool savePersistent() const;
+    // Schreibt die Änderungen seit dem letzten Aufruf als Journal-Einträge, bei Bedarf als neuen Snapshot.
+    bool savePersistent();
+    // Erzwingt einen neuen Snapshot und leert das Journal.
+    bool compact();
+    // savePersistent() in Schritten, damit Änderungen nicht auf den Flash warten: beginSave() und
+    // endSave() übernehmen bzw. verbuchen den Stand unter dem Schreib-Lock, writeSave() und
+    // removeReleased() schreiben ohne ihn. Es speichert immer nur ein Task zugleich.
+    // beginSave() liefert false, wenn nichts zu schreiben ist.
+    bool beginSave(SaveBatch& batch);
+    bool writeSave(SaveBatch& batch);
+    void endSave(SaveBatch& batch, bool ok);
+    void removeReleased(SaveBatch& batch);
+    // Übungen, deren Änderung savePersistent() noch schreiben muss
+    size_t pendingChanges() const { return pending_.size() + savingChanges_; }
+
+    // Aktueller Stand des Index, ohne Sperre; auch der Timer-Task holt ihn in jedem Durchlauf.
+    LibraryRef library() const;
 
-    Exercise* findExercise(const ExerciseId& id);
-    const Exercise* findExercise(const ExerciseId& id) const;
+    // Sets und Reps kommen aus dem Cache der Übungskörper, bei einem Fehlzugriff wird der Körper
+    // aus dem NVS nachgeladen. Der Cache hat einen eigenen Mutex; wer eine Übung bearbeiten will,
+    // holt sich mit toExercise() eine eigene Kopie.
+    ExerciseRef exerciseAt(const Library& library, size_t slot);
+    ExerciseRef find(const ExerciseId& id);
+    ExerciseRef resolve(ExerciseHandle& handle);
+    // Wie resolve(), aber nur aus dem Cache: ein Fehlzugriff liefert eine leere Referenz, ohne das
+    // NVS anzufassen. Für Tasks mit kleinem Stack; nachgeladen wird über PersistenceWorker::preload().
+    ExerciseRef resolveCached(ExerciseHandle& handle);
 
-    ExerciseRecord* findRecord(const ExerciseId& id);
-    const ExerciseRecord* findRecord(const ExerciseId& id) const;
+    struct CacheStats {
+        uint32_t hits = 0;
+        uint32_t loads = 0;     // aus dem NVS nachgeladene Körper
+        uint32_t evictions = 0;
+    };
+    CacheStats cacheStats() const;
 
     static ExerciseId fromHex(const String& hex);
     static String toHex(const ExerciseId& id);
 
-    const std::vector<ExerciseRecord>& exercises() const { return exercises_; }
+private:
+    static constexpr size_t kNotFound = SIZE_MAX;
+    static constexpr size_t kIdBytes = sizeof(ExerciseId);
+
+    // Übungskörper im Format von ExerciseView; dirty = noch nicht im NVS, bleibt bis dahin im Cache.
+    // released = ersetzt, bevor er je gespeichert wurde; bleibt für ältere Stände, die noch auf
+    // ihn zeigen, im Cache, bis keiner mehr gehalten wird.
+    struct CachedBody {
+        uint16_t key;
+        bool dirty;
+        bool released;
+        uint32_t lastUse;
+        std::shared_ptr<const std::vector<uint8_t>> bytes;
+    };
+
+    // Ersetzter Körper; stored = steht im NVS und muss dort noch gelöscht werden
+    struct ReleasedBody {
+        uint16_t key;
+        bool stored;
+    };
+
+    // nur noch für die Migration von v1
+    struct LegacyRecord {
+        ExerciseId id;
+        Exercise exercise;
+    };
+
+    enum class JournalOp : uint8_t { PUT = 1, REMOVE = 2 };
+    struct PendingChange {
+        JournalOp op;
+        ExerciseId id;
+    };
+
+public:
+    // Was ein Speichervorgang schreibt: der Stand bei beginSave() samt seinen Änderungen und
+    // ungespeicherten Körpern. Spätere Änderungen gehen in den nächsten Vorgang.
+    class SaveBatch {
+    private:
+        friend class StorageService;
+        LibraryRef library_;
+        std::vector<PendingChange> changes_;
+        std::vector<CachedBody> bodies_;
+        size_t written_ = 0;   // davon geschriebene Körper
+        size_t released_ = 0;  // Einträge in released_, auf die der geschriebene Index nicht mehr zeigt
+        std::vector<uint16_t> obsolete_; // nach endSave() im NVS zu löschen
+        bool snapshotPending_ = false;
+        bool compact_ = false;
+    };
 
 private:
     ExerciseId generateId();
-    bool idExists(const ExerciseId& id) const;
+    // Stand, auf dem der schreibende Task arbeitet: sein Entwurf, sonst der veröffentlichte Stand
+    const Library& latest() const;
+    Library& draft();
+    void publish();
+    void reclaim();
+    bool addBody(std::vector<uint8_t>&& body, ExerciseId* outId);
+    bool updateBody(const ExerciseId& id, std::vector<uint8_t>&& body);
+    void putExercise(const ExerciseId& id, const Exercise& exercise);
+    void putBody(const ExerciseId& id, std::vector<uint8_t>&& body);
+    void noteChange(JournalOp op, const ExerciseId& id);
     bool validateExercise(const Exercise& exercise) const;
-    bool serialize(std::vector<uint8_t>& buffer) const;
-    bool deserialize(const uint8_t* data, size_t length);
+    uint16_t allocateBodyKey() const;
+    void releaseBody(uint16_t key);
+    std::shared_ptr<const std::vector<uint8_t>> body(uint16_t key);
+    std::shared_ptr<const std::vector<uint8_t>> cachedBody(uint16_t key);
+    std::shared_ptr<const std::vector<uint8_t>> findBodyLocked(uint16_t key);
+    std::shared_ptr<const std::vector<uint8_t>> loadBody(uint16_t key);
+    void trimBodyCache();
+    void lockBodies() const;
+    void unlockBodies() const;
+    static size_t measureRecord(const uint8_t* data, size_t length);
+    static size_t measureExercise(const uint8_t* data, size_t length);
+    static bool readRecordV1(const uint8_t* data, size_t length, size_t& offset, LegacyRecord& record);
+    bool serialize(std::vector<uint8_t>& buffer, const Library& library) const;
+    bool deserialize(std::vector<uint8_t>&& buffer);
+    void replayJournal(Preferences& prefs);
+    bool appendJournal(Preferences& prefs, const SaveBatch& batch);
+    bool writeSnapshot(Preferences& prefs, const Library& library);
+    bool writeBodies(Preferences& prefs, SaveBatch& batch);
+
+    // Leser melden sich in acquiring_ für die wenigen Befehle zwischen dem Lesen von current_ und
+    // dem Hochzählen der Referenz an. Ersetzte Stände sammelt publish() in retired_ und gibt sie
+    // frei, sobald niemand mehr auf sie verweist.
+    std::atomic<const Library*> current_{nullptr};
+    mutable std::atomic<uint32_t> acquiring_{0};
+    Library* draft_ = nullptr; // gehört dem schreibenden Task, bis publish() ihn veröffentlicht
+    std::vector<const Library*> retired_;
+
+    // LRU der Übungskörper. Ein geänderter Körper bekommt einen neuen Schlüssel, der alte wird erst
+    // gelöscht, wenn der Index nicht mehr auf ihn zeigt (nach dem nächsten Speichern).
+    SemaphoreHandle_t bodyMutex_ = nullptr;
+    std::vector<CachedBody> bodies_;
+    std::vector<ReleasedBody> released_; // Schlüssel bleiben belegt, bis kein alter Stand mehr auf sie zeigt
+    uint32_t bodyClock_ = 0;
+    CacheStats cacheStats_{};
 
-    std::vector<ExerciseRecord> exercises_;
+    // Journal im NVS: Änderungen seit dem letzten savePersistent() und Stand der Einträge. Den
+    // Stand ab journalEpoch_ ändert nur der speichernde Task, auch in writeSave().
+    std::vector<PendingChange> pending_;
+    bool snapshotPending_ = false;
+    size_t savingChanges_ = 0; // zwischen beginSave() und endSave() unterwegs
+    uint32_t journalEpoch_ = 0;
+    uint16_t storedVersion_ = 0; // Format des geladenen Snapshots (0 = keiner), Journal-Einträge folgen ihm
+    size_t journalRecords_ = 0;
+    size_t journalBytes_ = 0;
 };
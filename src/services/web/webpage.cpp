@@ -23,10 +23,11 @@ struct SetInput {
 
 constexpr size_t kExerciseIdHexLength = StorageService::ExerciseId{}.size() * 2;
 
-String jsonEscape(const std::string& value) {
+String jsonEscape(const TextView& value) {
     String escaped;
-    escaped.reserve(value.length() + 8);
-    for (char c : value) {
+    escaped.reserve(value.size + 8);
+    for (size_t i = 0; i < value.size; ++i) {
+        const char c = value.data[i];
         switch (c) {
         case '"':
             escaped += "\\\"";
@@ -63,37 +64,50 @@ String jsonEscape(const std::string& value) {
     return escaped;
 }
 
-String exerciseRecordToJson(const StorageService::ExerciseRecord& record) {
+// Listeneintrag nur aus dem Index; Sets und Reps liefert /api/exercise
+String summaryToJson(const StorageService::ExerciseId& id, const ExerciseSummary& summary) {
+    String json = "{\"id\":\"";
+    json += StorageService::toHex(id);
+    json += "\",\"name\":\"";
+    json += jsonEscape(summary.name);
+    json += "\",\"setCount\":";
+    json += String(static_cast<unsigned long>(summary.setCount));
+    json += ",\"duration\":";
+    json += String(static_cast<unsigned long>(summary.durationS));
+    json += "}";
+    return json;
+}
+
+String exerciseToJson(const StorageService::ExerciseId& id, const ExerciseView& exercise) {
     String json = "{";
     json += "\"id\":\"";
-    json += StorageService::toHex(record.id);
+    json += StorageService::toHex(id);
     json += "\",\"name\":\"";
-    json += jsonEscape(record.exercise.name);
+    json += jsonEscape(exercise.name());
     json += "\",\"setCount\":";
-    json += String(static_cast<unsigned long>(record.exercise.sets.size()));
+    json += String(static_cast<unsigned long>(exercise.setCount()));
     json += ",\"sets\":[";
 
-    for (size_t i = 0; i < record.exercise.sets.size(); ++i) {
-        const Set& set = record.exercise.sets[i];
+    for (size_t i = 0; i < exercise.setCount(); ++i) {
+        const SetView set = exercise.set(i);
         if (i > 0) {
             json += ",";
         }
 
-        const int repDuration = set.reps.empty() ? 0 : set.reps.front().timeRep;
-        const int pauseBetween = set.reps.empty() ? 0 : set.reps.front().timeRest;
+        const Rep firstRep = set.rep(0);
 
         json += "{\"name\":\"";
-        json += jsonEscape(set.label);
+        json += jsonEscape(set.label());
         json += "\",\"reps\":";
-        json += String(static_cast<unsigned long>(set.reps.size()));
+        json += String(static_cast<unsigned long>(set.repCount()));
         json += ",\"repDuration\":";
-        json += String(repDuration);
+        json += String(firstRep.timeRep);
         json += ",\"pauseBetween\":";
-        json += String(pauseBetween);
+        json += String(firstRep.timeRest);
         json += ",\"pauseAfter\":";
-        json += String(set.timePauseAfter);
+        json += String(set.timePauseAfter());
         json += ",\"percentIntensity\":";
-        json += String(set.percentMaxIntensity);
+        json += String(set.percentMaxIntensity());
         json += "}";
     }
 
@@ -231,6 +245,7 @@ const char INDEX_PAGE[] PROGMEM = R"rawliteral(
 
         const MAX_SETS = 15; // keep in sync with StorageService::kMaxSets
         const MAX_REPS_PER_SET = 20; // keep in sync with StorageService::kMaxRepsPerSet
+        const MAX_DURATION_S = 65535; // keep in sync with limits::kMaxDurationS
 
         const addExerciseBtn = document.getElementById('addExerciseBtn');
         const exerciseSection = document.getElementById('exerciseSection');
@@ -249,8 +264,8 @@ const char INDEX_PAGE[] PROGMEM = R"rawliteral(
         const rowDefinitions = [
             { rowId: 'setLabelRow', name: 'name', type: 'text', placeholder: 'Set name', maxLength: '64', required: true, defaultValue: (i) => `Set ${i + 1}` },
             { rowId: 'repCountRow', name: 'reps', type: 'number', placeholder: '3', min: '1', max: String(MAX_REPS_PER_SET), step: '1', required: true, defaultValue: () => '3' },
-            { rowId: 'repDurationRow', name: 'repDuration', type: 'number', placeholder: '7', min: '1', step: '1', required: true, defaultValue: () => '7' },
-            { rowId: 'pauseBetweenRow', name: 'pauseBetween', type: 'number', placeholder: '30', min: '0', step: '1', required: true, defaultValue: () => '30' },
+            { rowId: 'repDurationRow', name: 'repDuration', type: 'number', placeholder: '7', min: '1', max: String(MAX_DURATION_S), step: '1', required: true, defaultValue: () => '7' },
+            { rowId: 'pauseBetweenRow', name: 'pauseBetween', type: 'number', placeholder: '30', min: '0', max: String(MAX_DURATION_S), step: '1', required: true, defaultValue: () => '30' },
             { rowId: 'pauseAfterRow', name: 'pauseAfter', type: 'number', placeholder: '180', min: '0', step: '1', required: true, defaultValue: () => '180' },
             { rowId: 'percentIntensityRow', name: 'percentIntensity', type: 'number', placeholder: '50', min: '0', step: '1', required: true, defaultValue: () => '50' }
         ];
@@ -442,15 +457,25 @@ const char INDEX_PAGE[] PROGMEM = R"rawliteral(
             exerciseNameMirror.addEventListener('input', () => syncValue(exerciseNameMirror, exerciseNameInput));
         }
 
-        exerciseListContainer.addEventListener('click', (event) => {
+        exerciseListContainer.addEventListener('click', async (event) => {
             const target = event.target.closest('.exercise-item');
             if (!target) {
                 return;
             }
             const id = target.getAttribute('data-id') || '';
-            const exercise = state.exercises.find((item) => item && item.id === id);
-            if (exercise) {
-                openEditForm(exercise);
+            if (!state.exercises.some((item) => item && item.id === id)) {
+                return;
+            }
+            // Die Liste enthält nur Name und Eckdaten, die Sets kommen einzeln
+            try {
+                const response = await fetch(`/api/exercise?id=${encodeURIComponent(id)}`, { cache: 'no-store' });
+                if (!response.ok) {
+                    throw new Error(`HTTP ${response.status}`);
+                }
+                openEditForm(await response.json());
+            } catch (error) {
+                console.error('Fehler beim Laden der Übung', error);
+                setStatus('Fehler beim Laden.', true);
             }
         });
 
@@ -541,7 +566,10 @@ const char INDEX_PAGE[] PROGMEM = R"rawliteral(
                         const safeId = exercise && exercise.id !== undefined ? exercise.id : '';
                         const safeName = escapeHtml(exercise && exercise.name ? exercise.name : 'Unbenannt');
                         const countValue = exercise && typeof exercise.setCount === 'number' ? exercise.setCount : 0;
-                        const setMeta = `${countValue} Sets`;
+                        const durationValue = exercise && typeof exercise.duration === 'number' ? exercise.duration : 0;
+                        const minutes = Math.floor(durationValue / 60);
+                        const seconds = String(durationValue % 60).padStart(2, '0');
+                        const setMeta = `${countValue} Sets · ${minutes}:${seconds} min`;
                         return `<button class="exercise-item" data-id="${escapeAttr(safeId)}">
                                     <span class="exercise-item__name">${safeName}</span>
                                     <span class="exercise-item__meta">${escapeHtml(setMeta)}</span>
@@ -574,8 +602,8 @@ WebService::WebService() : hasExercise_(0) {
     lastExerciseId_.fill(0);
 }
 
-const Exercise* WebService::lastExercise() const {
-    return hasExercise_ ? storageService.findExercise(lastExerciseId_) : nullptr;
+ExerciseSummary WebService::lastExercise(const StorageService::Library& library) const {
+    return hasExercise_ ? library.summaryOf(lastExerciseId_) : ExerciseSummary{};
 }
 
 void WebService::registerRoutes(WebServer& server) {
@@ -592,13 +620,13 @@ void WebService::registerRoutes(WebServer& server) {
 }
 
 void WebService::handleExercisesList(WebServer& server) {
+    const StorageService::LibraryRef library = storageService.library();
     String json = "{\"exercises\":[";
-    const auto& records = storageService.exercises();
-    for (size_t i = 0; i < records.size(); ++i) {
-        if (i > 0) {
+    for (size_t slot = 0; slot < library->size(); ++slot) {
+        if (slot > 0) {
             json += ",";
         }
-        json += exerciseRecordToJson(records[i]);
+        json += summaryToJson(library->idAt(slot), library->summaryAt(slot));
     }
     json += "]}";
     server.send(200, "application/json", json);
@@ -621,8 +649,8 @@ void WebService::handleExerciseDetail(WebServer& server) {
         return;
     }
 
-    if (const auto* record = storageService.findRecord(id)) {
-        server.send(200, "application/json", exerciseRecordToJson(*record));
+    if (const StorageService::ExerciseRef exercise = storageService.find(id)) {
+        server.send(200, "application/json", exerciseToJson(id, exercise.view()));
     } else {
         server.send(404, "application/json", "{\"status\":\"error\",\"message\":\"Not found\"}");
     }
@@ -646,12 +674,13 @@ void WebService::handleExerciseDelete(WebServer& server) {
         return;
     }
 
-    if (!storageService.removeExercise(id)) {
+    // nur im RAM; der PersistenceWorker schreibt verzögert ins NVS
+    if (!persistenceWorker.modify([&](StorageService& storage) { return storage.removeExercise(id); })) {
         server.send(404, "application/json", "{\"status\":\"error\",\"message\":\"Not found\"}");
         return;
     }
 
-    storageService.savePersistent();
+    timerScheduler.notify();
 
     if (hasExercise_ && id == lastExerciseId_) {
         hasExercise_ = 0;
@@ -723,15 +752,28 @@ void WebService::handleSubmit(WebServer& server) {
         }
     }
 
+    // Rep speichert nur 16 Bit; statt still auf die Grenze zu kürzen, wird die Übung abgelehnt
+    for (const auto& pair : sets) {
+        const SetInput& input = pair.second;
+        if (input.repDuration < 0 || input.repDuration > limits::kMaxDurationS || input.pauseBetween < 0 ||
+            input.pauseBetween > limits::kMaxDurationS) {
+            server.send(400, "application/json", "{\"status\":\"error\",\"message\":\"Invalid duration\"}");
+            return;
+        }
+    }
+
     if (!exerciseName.empty() && !sets.empty()) {
         if (exerciseName.length() > StorageService::kMaxExerciseNameLength) {
             exerciseName.resize(StorageService::kMaxExerciseNameLength);
         }
 
-        Exercise builtExercise(exerciseName);
-        size_t addedSets = 0;
+        // Die ganze Übung entsteht in einem Block; das Formular liefert eine Gruppe pro Set
+        const size_t setLimit = std::min(sets.size(), StorageService::kMaxSets);
+        ExerciseBuilder builtExercise(exerciseName,
+                                      ExerciseBuilder::capacity(setLimit, 1, StorageService::kMaxExerciseNameLength,
+                                                                StorageService::kMaxSetLabelLength));
         for (const auto& pair : sets) {
-            if (addedSets >= StorageService::kMaxSets) {
+            if (builtExercise.setCount() >= StorageService::kMaxSets) {
                 Serial.println("[Web] Set limit reached; remaining sets ignored.");
                 break;
             }
@@ -752,17 +794,17 @@ void WebService::handleSubmit(WebServer& server) {
                 setLabel.resize(StorageService::kMaxSetLabelLength);
             }
 
-            Set set(std::move(setLabel), input.pauseAfter, input.percentIntensity);
             int clampedReps = std::max(0, std::min(input.reps, static_cast<int>(StorageService::kMaxRepsPerSet)));
-            for (int r = 0; r < clampedReps; ++r) {
-                set.reps.emplace_back(input.repDuration, input.pauseBetween);
+            // Der Block ist nach den Grenzen bemessen; passt ein Set trotzdem nicht, wird die Übung
+            // abgelehnt statt unvollständig gespeichert
+            if (!builtExercise.addSet(setLabel, input.pauseAfter, input.percentIntensity) ||
+                !builtExercise.addReps(static_cast<uint32_t>(clampedReps), Rep(input.repDuration, input.pauseBetween))) {
+                server.send(400, "application/json", "{\"status\":\"error\",\"message\":\"Exercise exceeds limits\"}");
+                return;
             }
-
-            builtExercise.sets.push_back(std::move(set));
-            ++addedSets;
         }
 
-        if (builtExercise.sets.empty()) {
+        if (builtExercise.setCount() == 0) {
             Serial.println("[Web] No sets after applying limits.");
         } else {
             StorageService::ExerciseId storedId{};
@@ -770,21 +812,26 @@ void WebService::handleSubmit(WebServer& server) {
             bool updated = false;
 
             if (updateRequested) {
-                if (storageService.updateExercise(updateId, builtExercise)) {
+                if (persistenceWorker.modify([&](StorageService& storage) {
+                        return storage.updateExercise(updateId, builtExercise.view());
+                    })) {
                     storedId = updateId;
                     stored = true;
                     updated = true;
                     Serial.println("[Web] Exercise updated in memory.");
                 }
             } else {
-                if (storageService.addExercise(builtExercise, &storedId)) {
+                if (persistenceWorker.modify([&](StorageService& storage) {
+                        return storage.addExercise(builtExercise.view(), &storedId);
+                    })) {
                     stored = true;
                     Serial.println("[Web] Exercise stored in memory.");
                 }
             }
 
+            // Geschrieben wird im PersistenceWorker, gesammelt mit weiteren Änderungen
             if (stored) {
-                storageService.savePersistent();
+                timerScheduler.notify();
                 lastExerciseId_ = storedId;
                 hasExercise_ = 1;
                 String response = "{\"status\":\"ok\",\"id\":\"";
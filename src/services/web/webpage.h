@@ -13,7 +13,8 @@ public:
 
     void registerRoutes(WebServer& server);
 
-    const Exercise* lastExercise() const;
+    // Der Name zeigt in library und gilt, solange sie gehalten wird
+    ExerciseSummary lastExercise(const StorageService::Library& library) const;
 
 private:
     void handleExercisesList(WebServer& server);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Text mit höchstens Capacity Zeichen im Objekt selbst, nullterminiert und ohne Heap. Die
+// Schnittstelle ist die Teilmenge von std::string, die die Modelltypen brauchen; längere Texte
+// werden beim Zuweisen auf Capacity Zeichen gekürzt, truncated() meldet das.
+template <size_t Capacity>
+class InlineString {
+public:
+    InlineString() = default;
+    InlineString(const char* text) { assign(text, std::strlen(text)); }
+    InlineString(const std::string& text) { assign(text.data(), text.size()); }
+
+    InlineString& assign(const char* text, size_t length) {
+        truncated_ = length > Capacity;
+        size_ = static_cast<Size>(length < Capacity ? length : Capacity);
+        std::memcpy(data_, text, size_);
+        data_[size_] = '\0';
+        return *this;
+    }
+    // Neue Zeichen sind '\0', wie bei std::string::resize()
+    void resize(size_t length) {
+        truncated_ = length > Capacity;
+        length = length < Capacity ? length : Capacity;
+        if (length > size_) {
+            std::memset(data_ + size_, 0, length - size_);
+        }
+        size_ = static_cast<Size>(length);
+        data_[size_] = '\0';
+    }
+    void clear() { resize(0); }
+
+    char& operator[](size_t index) { return data_[index]; }
+    const char& operator[](size_t index) const { return data_[index]; }
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    const char* c_str() const { return data_; }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    size_t length() const { return size_; }
+    static constexpr size_t capacity() { return Capacity; }
+    // true, wenn die letzte Zuweisung bzw. resize() mehr als Capacity Zeichen verlangte
+    bool truncated() const { return truncated_; }
+
+    bool operator==(const InlineString& other) const {
+        return size_ == other.size_ && std::memcmp(data_, other.data_, size_) == 0;
+    }
+    bool operator!=(const InlineString& other) const { return !(*this == other); }
+
+private:
+    using Size = typename std::conditional<(Capacity <= UINT8_MAX), uint8_t, size_t>::type;
+
+    char data_[Capacity + 1] = {};
+    Size size_ = 0;
+    bool truncated_ = false;
+};
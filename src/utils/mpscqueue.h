@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Begrenzte lock-freie Queue für mehrere Produzenten und genau einen Konsumenten.
+// Jede Zelle trägt eine Sequenznummer, über die Produzenten per CAS einen Platz
+// reservieren und dem Konsumenten das fertige Element freigeben.
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscQueue() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence.store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const T& item) {
+        uint32_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & kMask];
+            const uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const int32_t diff = static_cast<int32_t>(sequence - pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.item = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // voll
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T& out) {
+        Cell& cell = cells_[dequeuePos_ & kMask];
+        const uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<int32_t>(sequence - (dequeuePos_ + 1)) < 0) {
+            return false; // leer oder Produzent schreibt noch
+        }
+        out = cell.item;
+        cell.sequence.store(dequeuePos_ + static_cast<uint32_t>(Capacity), std::memory_order_release);
+        ++dequeuePos_;
+        return true;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr uint32_t kMask = static_cast<uint32_t>(Capacity - 1);
+
+    struct Cell {
+        std::atomic<uint32_t> sequence{0};
+        T item{};
+    };
+
+    std::array<Cell, Capacity> cells_;
+    std::atomic<uint32_t> enqueuePos_{0};
+    uint32_t dequeuePos_ = 0; // nur vom Konsumenten benutzt
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Vektor mit fester Kapazität: die Elemente liegen im Objekt selbst, nie auf dem Heap. Die
+// Schnittstelle ist die Teilmenge von std::vector, die die Modelltypen brauchen. Ist der Vektor
+// voll, hängen push_back()/emplace_back() nichts an, liefern false und merken sich das für
+// overflowed().
+template <typename T, size_t Capacity>
+class StaticVector {
+    static_assert(Capacity > 0, "Capacity must not be zero");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    StaticVector() = default;
+    StaticVector(const StaticVector& other) : overflowed_(other.overflowed_) {
+        for (const T& item : other) {
+            emplace_back(item);
+        }
+    }
+    StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : overflowed_(other.overflowed_) {
+        for (T& item : other) {
+            emplace_back(std::move(item));
+        }
+    }
+    StaticVector& operator=(const StaticVector& other) {
+        if (this != &other) {
+            clear();
+            for (const T& item : other) {
+                emplace_back(item);
+            }
+            overflowed_ = other.overflowed_;
+        }
+        return *this;
+    }
+    StaticVector& operator=(StaticVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            clear();
+            for (T& item : other) {
+                emplace_back(std::move(item));
+            }
+            overflowed_ = other.overflowed_;
+        }
+        return *this;
+    }
+    ~StaticVector() { clear(); }
+
+    template <typename... Args>
+    bool emplace_back(Args&&... args) {
+        if (size_ >= Capacity) {
+            overflowed_ = true;
+            return false;
+        }
+        new (data() + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        return true;
+    }
+    bool push_back(const T& item) { return emplace_back(item); }
+    bool push_back(T&& item) { return emplace_back(std::move(item)); }
+
+    void pop_back() {
+        data()[--size_].~T();
+    }
+    void clear() {
+        while (size_ > 0) {
+            pop_back();
+        }
+        overflowed_ = false;
+    }
+    // Kapazität steht fest; nur der Vollständigkeit halber wie bei std::vector
+    void reserve(size_t) {}
+
+    T& operator[](size_t index) { return data()[index]; }
+    const T& operator[](size_t index) const { return data()[index]; }
+    T& front() { return data()[0]; }
+    const T& front() const { return data()[0]; }
+    T& back() { return data()[size_ - 1]; }
+    const T& back() const { return data()[size_ - 1]; }
+
+    T* data() { return reinterpret_cast<T*>(storage_); }
+    const T* data() const { return reinterpret_cast<const T*>(storage_); }
+    iterator begin() { return data(); }
+    iterator end() { return data() + size_; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    static constexpr size_t capacity() { return Capacity; }
+    static constexpr size_t max_size() { return Capacity; }
+    // true, wenn seit dem letzten clear() ein Element nicht mehr hineinpasste
+    bool overflowed() const { return overflowed_; }
+
+private:
+    using Size = typename std::conditional<(Capacity <= UINT8_MAX), uint8_t, size_t>::type;
+
+    alignas(T) unsigned char storage_[Capacity * sizeof(T)];
+    Size size_ = 0;
+    bool overflowed_ = false;
+};